@@ -1,12 +1,23 @@
 #ifndef __CYLIBX_H__
 #define __CYLIBX_H__
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif // __linux__
+
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif // __linux__
 
 #define __CYX_CLOSE_FOLD 1
 
@@ -98,19 +109,205 @@ void* __cyx_temp_alloc_deleted(size_t bytes, void* val, char is_ptr, void(*fn)(v
 	(header)->cmp_fn(__CYX_DATA_GET_AT(header, data_ptr, l_pos), __CYX_DATA_GET_AT(header, data_ptr, r_pos)) : \
 	(header)->cmp_fn(*(void**)(__CYX_DATA_GET_AT(header, data_ptr, l_pos)), *(void**)(__CYX_DATA_GET_AT(header, data_ptr, r_pos))) \
 )
-#define __CYX_SWAP(a, b, size) do { \
-	__cyx_temp_buffer_marker_set(); \
-		void* temp = __cyx_temp_buffer_alloc(size); \
-		assert(temp && "ERROR: Can not allocate to the temporary buffer anymore!"); \
-		memcpy(temp, a, size); \
-		memcpy(a, b, size); \
-		memcpy(b, temp, size); \
-	__cyx_temp_buffer_marker_reset(); \
-} while(0);
+#define __CYX_SWAP(a, b, size) __cyx_swap(a, b, size)
 #define __CYX_CONCAT_VALS_BASE__(a, b) a##b
 #define __CYX_CONCAT_VALS__(a, b) __CYX_CONCAT_VALS_BASE__(a, b)
 #define __CYX_UNIQUE_VAL__(a) __CYX_CONCAT_VALS__(a, __LINE__)
 
+static inline void __cyx_swap(void* a, void* b, size_t size) {
+	switch (size) {
+	case 4: { uint32_t t; memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4); } return;
+	case 8: { uint64_t t; memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8); } return;
+	case 16: { uint64_t t[2]; memcpy(t, a, 16); memcpy(a, b, 16); memcpy(b, t, 16); } return;
+	}
+	char t[64];
+	char* l = a;
+	char* r = b;
+	for (; size >= sizeof(t); size -= sizeof(t), l += sizeof(t), r += sizeof(t)) {
+		memcpy(t, l, sizeof(t));
+		memcpy(l, r, sizeof(t));
+		memcpy(r, t, sizeof(t));
+	}
+	memcpy(t, l, size);
+	memcpy(l, r, size);
+	memcpy(r, t, size);
+}
+static inline void __cyx_copy(void* dst, const void* src, size_t size) {
+	switch (size) {
+	case 4: memcpy(dst, src, 4); return;
+	case 8: memcpy(dst, src, 8); return;
+	case 16: memcpy(dst, src, 16); return;
+	}
+	memcpy(dst, src, size);
+}
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Memory
+ */
+
+#if __CYX_CLOSE_FOLD
+
+// blocks of at least this many bytes are backed by their own mapping so they can grow with mremap
+#ifndef CYX_MMAP_THRESHOLD
+#define CYX_MMAP_THRESHOLD (1 << 24)
+#endif // CYX_MMAP_THRESHOLD
+#ifndef CYX_HUGE_PAGE_SIZE
+#define CYX_HUGE_PAGE_SIZE (1 << 21)
+#endif // CYX_HUGE_PAGE_SIZE
+
+void* __cyx_mem_alloc(size_t bytes, char huge_pages, char* is_mmap);
+void* __cyx_mem_realloc(void* block, size_t old_bytes, size_t used_bytes, size_t new_bytes, char huge_pages, char* is_mmap);
+void __cyx_mem_free(void* block, size_t bytes, char is_mmap);
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+#ifdef __linux__
+static inline size_t __cyx_mem_threshold(char huge_pages) {
+	return huge_pages ? CYX_HUGE_PAGE_SIZE : CYX_MMAP_THRESHOLD;
+}
+static void* __cyx_mem_map(size_t bytes, char huge_pages) {
+	void* block = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (block == MAP_FAILED) { return NULL; }
+#ifdef MADV_HUGEPAGE
+	if (huge_pages) { madvise(block, bytes, MADV_HUGEPAGE); }
+#endif // MADV_HUGEPAGE
+	return block;
+}
+#endif // __linux__
+
+void* __cyx_mem_alloc(size_t bytes, char huge_pages, char* is_mmap) {
+	*is_mmap = 0;
+#ifdef __linux__
+	if (bytes >= __cyx_mem_threshold(huge_pages)) {
+		void* block = __cyx_mem_map(bytes, huge_pages);
+		if (block) { *is_mmap = 1; return block; }
+	}
+#else
+	(void)huge_pages;
+#endif // __linux__
+	return malloc(bytes);
+}
+// `used_bytes` is the prefix of the block that has to survive the move, `old_bytes` is its full size
+void* __cyx_mem_realloc(void* block, size_t old_bytes, size_t used_bytes, size_t new_bytes, char huge_pages, char* is_mmap) {
+#ifdef __linux__
+	if (*is_mmap) {
+#ifdef MREMAP_MAYMOVE
+		void* res = mremap(block, old_bytes, new_bytes, MREMAP_MAYMOVE);
+		if (res == MAP_FAILED) { return NULL; }
+#ifdef MADV_HUGEPAGE
+		if (huge_pages) { madvise(res, new_bytes, MADV_HUGEPAGE); }
+#endif // MADV_HUGEPAGE
+		return res;
+#else
+		void* res = __cyx_mem_map(new_bytes, huge_pages);
+		if (!res) { return NULL; }
+		memcpy(res, block, used_bytes < new_bytes ? used_bytes : new_bytes);
+		munmap(block, old_bytes);
+		return res;
+#endif // MREMAP_MAYMOVE
+	}
+	if (new_bytes >= __cyx_mem_threshold(huge_pages)) {
+		void* res = __cyx_mem_map(new_bytes, huge_pages);
+		if (res) {
+			memcpy(res, block, used_bytes < new_bytes ? used_bytes : new_bytes);
+			free(block);
+			*is_mmap = 1;
+			return res;
+		}
+	}
+#else
+	(void)huge_pages;
+	(void)is_mmap;
+#endif // __linux__
+	(void)old_bytes;
+	(void)used_bytes;
+	return realloc(block, new_bytes);
+}
+void __cyx_mem_free(void* block, size_t bytes, char is_mmap) {
+#ifdef __linux__
+	if (is_mmap) { munmap(block, bytes); return; }
+#else
+	(void)is_mmap;
+#endif // __linux__
+	(void)bytes;
+	free(block);
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Threads
+ */
+
+#if __CYX_CLOSE_FOLD
+
+struct __CyxThreadTask {
+	size_t id;
+	size_t count;
+	size_t start;
+	size_t end;
+
+	void* ctx;
+	void (*fn)(struct __CyxThreadTask*);
+};
+
+#ifndef CYX_THREADS_MAX
+#define CYX_THREADS_MAX 256
+#endif // CYX_THREADS_MAX
+
+size_t __cyx_thread_count(size_t requested, size_t n);
+void __cyx_parallel_run(size_t nthreads, size_t n, void (*fn)(struct __CyxThreadTask*), void* ctx);
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+size_t __cyx_thread_count(size_t requested, size_t n) {
+	if (!requested) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		requested = online > 0 ? (size_t)online : 1;
+	}
+	if (requested > CYX_THREADS_MAX) { requested = CYX_THREADS_MAX; }
+	if (requested > n) { requested = n ? n : 1; }
+	return requested;
+}
+static void* __cyx_thread_entry(void* task) {
+	((struct __CyxThreadTask*)task)->fn(task);
+	return NULL;
+}
+void __cyx_parallel_run(size_t nthreads, size_t n, void (*fn)(struct __CyxThreadTask*), void* ctx) {
+	nthreads = __cyx_thread_count(nthreads, n);
+
+	struct __CyxThreadTask* tasks = malloc(nthreads * (sizeof(struct __CyxThreadTask) + sizeof(pthread_t)));
+	assert(tasks);
+	pthread_t* threads = (pthread_t*)(tasks + nthreads);
+
+	for (size_t i = 0; i < nthreads; ++i) {
+		tasks[i] = (struct __CyxThreadTask){
+			.id = i,
+			.count = nthreads,
+			.start = n / nthreads * i + (i < n % nthreads ? i : n % nthreads),
+			.ctx = ctx,
+			.fn = fn,
+		};
+		tasks[i].end = tasks[i].start + n / nthreads + (i < n % nthreads);
+	}
+
+	size_t started = 1;
+	for (; started < nthreads; ++started) {
+		if (pthread_create(&threads[started], NULL, __cyx_thread_entry, &tasks[started])) { break; }
+	}
+	fn(&tasks[0]);
+	for (size_t i = started; i < nthreads; ++i) { fn(&tasks[i]); }
+	for (size_t i = 1; i < started; ++i) { pthread_join(threads[i], NULL); }
+
+	free(tasks);
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
 #endif // __CYX_CLOSE_FOLD
 
 /*
@@ -202,6 +399,7 @@ int cyx_str_cmp(const void* val1, const void* val2) {
 	int ret = strncmp(str1, str2, cyx_str_length(str1) < cyx_str_length(str2) ? cyx_str_length(str1) : cyx_str_length(str2)); 
 	if (ret < 0) return -1;
 	else if (ret > 0) return 1;
+	else if (cyx_str_length(str1) != cyx_str_length(str2)) return cyx_str_length(str1) < cyx_str_length(str2) ? -1 : 1;
 	else return 0;
 }
 
@@ -219,18 +417,27 @@ typedef struct {
 	size_t size;
 	size_t len;
 	size_t cap;
+	float growth;
 
 	void (*defer_fn)(void*);
 	int (*cmp_fn)(const void*, const void*);
 	void (*print_fn)(const void*);
 
 	char is_ptr;
+	char is_mmap;
+	char huge_pages;
+	// elements live in caller provided storage until the first growth moves them to the heap
+	char is_inline;
 } __CyxArrayHeader;
 
 struct __CyxArrayParams {
 	size_t __size;
 	size_t reserve;
+	// factor the capacity is multiplied by when the array runs out of space, defaults to CYX_ARRAY_GROWTH
+	float growth;
 	char is_ptr;
+	// back large arrays with transparent huge pages
+	char huge_pages;
 
 	void (*defer_fn)(void*);
 	int (*cmp_fn)(const void*, const void*);
@@ -240,21 +447,76 @@ struct __CyxArrayParams {
 #ifndef CYX_ARRAY_BASE_SIZE
 #define CYX_ARRAY_BASE_SIZE 16
 #endif // CYX_ARRAY_BASE_SIZE
+#ifndef CYX_ARRAY_GROWTH
+#define CYX_ARRAY_GROWTH 2.0f
+#endif // CYX_ARRAY_GROWTH
 
 #define __CYX_ARRAY_HEADER_SIZE (sizeof(__CyxArrayHeader))
 #define __CYX_ARRAY_GET_HEADER(arr) ((__CyxArrayHeader*)(arr) - 1)
 
 void* __cyx_array_new(struct __CyxArrayParams params);
+void* __cyx_array_new_inline(__CyxArrayHeader* storage, size_t n, struct __CyxArrayParams params);
 void* __cyx_array_copy(void* arr);
+void __cyx_array_realloc(void** arr_ptr, size_t cap);
 void __cyx_array_expand(void** arr_ptr, size_t n);
+void __cyx_array_reserve(void** arr_ptr, size_t n);
+void __cyx_array_resize(void** arr_ptr, size_t n);
+void __cyx_array_shrink_to_fit(void** arr_ptr);
+void cyx_array_clear(void* arr);
 void __cyx_array_append(void** arr, void* val);
 void* __cyx_array_remove(void* arr, int pos);
+void __cyx_array_insert_n_at(void** arr_ptr, size_t pos, size_t n, const void* mult);
+void* __cyx_array_remove_ordered(void* arr, int pos);
+void cyx_array_remove_range(void* arr, size_t pos, size_t n);
+size_t cyx_array_remove_if(void* arr, int (*fn)(const void*));
+size_t cyx_array_unique_sorted(void* arr);
+size_t cyx_array_unique_hashed(void* arr, size_t (*hash_fn)(const void* const), int (*eq_fn)(const void* const, const void* const));
 void* __cyx_array_at(void* arr, int pos);
 void cyx_array_free(void* arr);
 void __cyx_array_append_mult_n(void** arr_ptr, size_t n, const void* mult);
 void cyx_array_print(const void* arr);
 
-void __cyx_array_sort(void* arr, int start, int end);
+typedef enum {
+	CYX_KEY_I32,
+	CYX_KEY_U32,
+	CYX_KEY_I64,
+	CYX_KEY_U64,
+	CYX_KEY_F32,
+	CYX_KEY_F64,
+} CyxKeyType;
+
+struct __CyxSortCtx {
+	size_t size;
+	int (*cmp_fn)(const void*, const void*);
+	char is_ptr;
+};
+
+#define __CYX_SORT_INSERTION_LIMIT 16
+#define __CYX_SORT_NINTHER_LIMIT 128
+#define __CYX_SORT_TMP_SIZE 256
+#define __CYX_SORT_PARALLEL_MIN 16384
+#define __CYX_PARALLEL_GRAIN 4096
+#define __CYX_TIMSORT_MIN_MERGE 32
+#define __CYX_TIMSORT_MIN_GALLOP 7
+#define __CYX_TIMSORT_MAX_RUNS 85
+
+void __cyx_sort_range(void* base, size_t n, size_t size, int (*cmp_fn)(const void*, const void*), char is_ptr);
+void __cyx_array_sort(void* arr);
+size_t __cyx_lower_bound(const void* base, size_t n, const void* val, struct __CyxSortCtx* ctx);
+size_t __cyx_upper_bound(const void* base, size_t n, const void* val, struct __CyxSortCtx* ctx);
+int __cyx_array_bsearch(void* arr, const void* val);
+size_t __cyx_array_lower_bound(void* arr, const void* val);
+size_t __cyx_array_upper_bound(void* arr, const void* val);
+void* cyx_array_build_eytzinger(void* arr);
+int __cyx_array_eytzinger_lower_bound(void* eyt, const void* val);
+int __cyx_array_eytzinger_bsearch(void* eyt, const void* val);
+void __cyx_array_sort_parallel(void* arr, size_t nthreads);
+void __cyx_sort_stable_range(void* base, size_t n, size_t size, int (*cmp_fn)(const void*, const void*), char is_ptr);
+void __cyx_array_sort_stable(void* arr);
+void __cyx_array_sort_radix(void* arr, CyxKeyType key_type, size_t key_offset);
+void __cyx_array_nth_element(void* arr, size_t k);
+void __cyx_array_partial_sort(void* arr, size_t k);
+void* __cyx_array_top_k(const void* arr, size_t k);
 void* __cyx_array_map(const void* const arr, void (*fn)(void*, const void*));
 void* cyx_array_map_self(void* arr, void (*fn)(void*, const void*));
 void* __cyx_array_filter(const void* const arr, int (*fn)(const void*));
@@ -262,6 +524,9 @@ void* cyx_array_filter_self(void* arr, int (*fn)(const void*));
 int cyx_array_find(void* arr, void* val);
 int cyx_array_find_by(void* arr, int (*fn)(const void*));
 void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const void*));
+void* __cyx_array_map_par(const void* const arr, void (*fn)(void*, const void*), size_t nthreads);
+void* __cyx_array_filter_par(const void* const arr, int (*fn)(const void*), size_t nthreads);
+void* __cyx_array_fold_par(void* arr, void* accumulator, void (*fn)(void*, const void*), void (*combine_fn)(void*, const void*), size_t nthreads);
 
 #define cyx_array_length(arr) (__CYX_ARRAY_GET_HEADER(arr)->len)
 #define cyx_array_foreach(val, arr) for ( struct { typeof(*arr)* value; size_t idx; } val = { .value = arr, .idx = 0 }; val.idx < array_length(arr); ++val.idx, val.value = (typeof(*arr)*)((char*)val.value + __CYX_ARRAY_GET_HEADER(arr)->size) )
@@ -269,7 +534,19 @@ void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const voi
 
 #define __cyx_array_new_params(...) __cyx_array_new((struct __CyxArrayParams){ 0, __VA_ARGS__ })
 #define cyx_array_new(T, ...) (T*)__cyx_array_new_params(.__size = sizeof(T), __VA_ARGS__)
+// small vector storage for `N` elements, can be a local variable or a member of another struct
+#define CYX_ARRAY_STORAGE(T, N) struct { __CyxArrayHeader __head; T __data[N]; }
+// the first `N` elements live on the stack of the enclosing block, the array must not be used after the block ends
+#define cyx_array_new_inline(T, N, ...) (T*)__cyx_array_new_inline(&(CYX_ARRAY_STORAGE(T, N)){ 0 }.__head, N, \
+	(struct __CyxArrayParams){ 0, .__size = sizeof(T), __VA_ARGS__ })
+#define cyx_array_new_in(storage, ...) (typeof(*(storage).__data)*)__cyx_array_new_inline(&(storage).__head, sizeof((storage).__data) / sizeof(*(storage).__data), \
+	(struct __CyxArrayParams){ 0, .__size = sizeof(*(storage).__data), __VA_ARGS__ })
 #define cyx_array_copy(arr) (typeof(*arr)*)__cyx_array_copy(arr)
+// makes room for at least `n` elements in total
+#define cyx_array_reserve(arr, n) __cyx_array_reserve((void**)&(arr), n)
+// new elements are zeroed, dropped ones go through `defer_fn`
+#define cyx_array_resize(arr, n) __cyx_array_resize((void**)&(arr), n)
+#define cyx_array_shrink_to_fit(arr) __cyx_array_shrink_to_fit((void**)&(arr))
 #define cyx_array_append(arr, val) do { \
 	typeof(*arr) v = (val); \
 	__cyx_array_append((void**)&arr, &v); \
@@ -280,20 +557,85 @@ void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const voi
 	__cyx_array_append_mult_n((void**)&(arr), sizeof(mult)/sizeof(*(mult)), mult); \
 } while(0)
 #define cyx_array_remove(arr, pos) (typeof(*arr)*)__cyx_array_remove(arr, pos)
+#define cyx_array_insert_at(arr, pos, val) do { \
+	typeof(*arr) v = (val); \
+	__cyx_array_insert_n_at((void**)&(arr), pos, 1, &v); \
+} while(0)
+#define cyx_array_insert_n_at(arr, pos, n, mult) __cyx_array_insert_n_at((void**)&(arr), pos, n, mult)
+// keeps the order of the remaining elements, unlike `cyx_array_remove`
+#define cyx_array_remove_ordered(arr, pos) (typeof(*arr)*)__cyx_array_remove_ordered(arr, pos)
 #define cyx_array_pop(arr) (typeof(*arr)*)__cyx_array_remove(arr, -1)
 #define cyx_array_at(arr, pos) (typeof(*arr)*)__cyx_array_at(arr, pos)
 #define cyx_array_set_cmp(arr, cmp) do { __CYX_ARRAY_GET_HEADER(arr)->cmp_fn = cmp; } while(0)
 #define cyx_array_sort(arr) do { \
 	assert(arr); \
 	assert(__CYX_ARRAY_GET_HEADER(arr)->cmp_fn && "ERROR: Trying to sort without a compare function provided!"); \
-	__cyx_array_sort(arr, 0, __CYX_ARRAY_GET_HEADER(arr)->len - 1); \
+	__cyx_array_sort(arr); \
+} while(0)
+// timsort, keeps the order of equal elements and runs in close to linear time on mostly sorted arrays
+#define cyx_array_sort_stable(arr) do { \
+	assert(arr); \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->cmp_fn && "ERROR: Trying to sort without a compare function provided!"); \
+	__cyx_array_sort_stable(arr); \
+} while(0)
+// `nthreads` = 0 uses every online cpu
+#define cyx_array_sort_parallel(arr, nthreads) do { \
+	assert(arr); \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->cmp_fn && "ERROR: Trying to sort without a compare function provided!"); \
+	__cyx_array_sort_parallel(arr, nthreads); \
+} while(0)
+// the searches below expect the array to be sorted by its `cmp_fn`
+#define cyx_array_bsearch(arr, val) ({ \
+	typeof(*arr) v = (val); \
+	__cyx_array_bsearch(arr, &v); \
+})
+#define cyx_array_lower_bound(arr, val) ({ \
+	typeof(*arr) v = (val); \
+	__cyx_array_lower_bound(arr, &v); \
+})
+#define cyx_array_upper_bound(arr, val) ({ \
+	typeof(*arr) v = (val); \
+	__cyx_array_upper_bound(arr, &v); \
+})
+// eytzinger arrays are BFS ordered copies of a sorted array, indices returned by their searches point into the copy
+#define cyx_array_eytzinger_lower_bound(eyt, val) ({ \
+	typeof(*eyt) v = (val); \
+	__cyx_array_eytzinger_lower_bound(eyt, &v); \
+})
+#define cyx_array_eytzinger_bsearch(eyt, val) ({ \
+	typeof(*eyt) v = (val); \
+	__cyx_array_eytzinger_bsearch(eyt, &v); \
+})
+// puts the element that would land at `k` after sorting there, nothing before it is greater and nothing after it is smaller
+#define cyx_array_nth_element(arr, k) do { \
+	assert(arr); \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->cmp_fn && "ERROR: Trying to sort without a compare function provided!"); \
+	__cyx_array_nth_element(arr, k); \
+} while(0)
+// sorts only the first `k` elements, the rest is left in unspecified order
+#define cyx_array_partial_sort(arr, k) do { \
+	assert(arr); \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->cmp_fn && "ERROR: Trying to sort without a compare function provided!"); \
+	__cyx_array_partial_sort(arr, k); \
 } while(0)
+// new sorted array of the `k` first elements in `cmp_fn` order, reverse `cmp_fn` to get the largest ones
+#define cyx_array_top_k(arr, k) (typeof(*arr)*)__cyx_array_top_k(arr, k)
+// stable LSD radix sort on a numeric key stored `key_offset` bytes into every element
+#define cyx_array_sort_radix(arr, key_type, key_offset) __cyx_array_sort_radix(arr, key_type, key_offset)
 #define cyx_array_map(arr, fn) (typeof(*arr)*)__cyx_array_map(arr, fn)
 #define cyx_array_filter(arr, fn) (typeof(*arr)*)__cyx_array_filter(arr, fn)
 #define cyx_array_fold(arr, accumulator, fn) ({ \
 	typeof(*arr) acc = (accumulator); \
 	(typeof(*arr)*)__cyx_array_fold(arr, &acc, fn); \
 })
+// `fn` is called from several threads at once, `nthreads` = 0 uses every online cpu
+#define cyx_array_map_par(arr, fn, nthreads) (typeof(*arr)*)__cyx_array_map_par(arr, fn, nthreads)
+#define cyx_array_filter_par(arr, fn, nthreads) (typeof(*arr)*)__cyx_array_filter_par(arr, fn, nthreads)
+// every thread starts from `accumulator` so it has to be the identity of `combine_fn`, partial results are combined in order
+#define cyx_array_fold_par(arr, accumulator, fn, combine_fn, nthreads) ({ \
+	typeof(*arr) acc = (accumulator); \
+	(typeof(*arr)*)__cyx_array_fold_par(arr, &acc, fn, combine_fn, nthreads); \
+})
 
 #ifdef CYLIBX_STRIP_PREFIX
 
@@ -302,71 +644,191 @@ void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const voi
 #define array_drain(val, arr) cyx_array_drain(val, arr)
 
 #define array_new(T, ...) cyx_array_new(T, __VA_ARGS__) 
+#define ARRAY_STORAGE(T, N) CYX_ARRAY_STORAGE(T, N)
+#define array_new_inline(T, N, ...) cyx_array_new_inline(T, N, __VA_ARGS__)
+#define array_new_in(storage, ...) cyx_array_new_in(storage, __VA_ARGS__)
 #define array_copy(arr) cyx_array_copy(arr)
+#define array_reserve(arr, n) cyx_array_reserve(arr, n)
+#define array_resize(arr, n) cyx_array_resize(arr, n)
+#define array_shrink_to_fit(arr) cyx_array_shrink_to_fit(arr)
 #define array_append(arr, val) cyx_array_append(arr, val)
 #define array_append_mult_n(arr, n, mult) cyx_array_append_mult_n(arr, n, mult)
 #define array_append_mult(arr, ...) cyx_array_append_mult(arr, __VA_ARGS__)
 #define array_remove(arr, pos) cyx_array_remove(arr, pos)
+#define array_insert_at(arr, pos, val) cyx_array_insert_at(arr, pos, val)
+#define array_insert_n_at(arr, pos, n, mult) cyx_array_insert_n_at(arr, pos, n, mult)
+#define array_remove_ordered(arr, pos) cyx_array_remove_ordered(arr, pos)
 #define array_pop(arr) cyx_array_pop(arr)
 #define array_at(arr, pos) cyx_array_at(arr, pos)
 #define array_set_cmp(arr, cmp) cyx_array_set_cmp(arr, cmp)
 #define array_sort(arr) cyx_array_sort(arr)
+#define array_sort_stable(arr) cyx_array_sort_stable(arr)
+#define array_sort_parallel(arr, nthreads) cyx_array_sort_parallel(arr, nthreads)
+#define array_sort_radix(arr, key_type, key_offset) cyx_array_sort_radix(arr, key_type, key_offset)
+#define array_nth_element(arr, k) cyx_array_nth_element(arr, k)
+#define array_partial_sort(arr, k) cyx_array_partial_sort(arr, k)
+#define array_top_k(arr, k) cyx_array_top_k(arr, k)
+#define array_bsearch(arr, val) cyx_array_bsearch(arr, val)
+#define array_lower_bound(arr, val) cyx_array_lower_bound(arr, val)
+#define array_upper_bound(arr, val) cyx_array_upper_bound(arr, val)
+#define array_eytzinger_lower_bound(eyt, val) cyx_array_eytzinger_lower_bound(eyt, val)
+#define array_eytzinger_bsearch(eyt, val) cyx_array_eytzinger_bsearch(eyt, val)
 #define array_map(arr, fn) cyx_array_map(arr, fn)
 #define array_filter(arr, fn) cyx_array_filter(arr, fn)
 #define array_fold(arr, accumulator, fn) cyx_array_fold(arr, accumulator, fn)
+#define array_map_par(arr, fn, nthreads) cyx_array_map_par(arr, fn, nthreads)
+#define array_filter_par(arr, fn, nthreads) cyx_array_filter_par(arr, fn, nthreads)
+#define array_fold_par(arr, accumulator, fn, combine_fn, nthreads) cyx_array_fold_par(arr, accumulator, fn, combine_fn, nthreads)
 
 #define array_free cyx_array_free
+#define array_clear cyx_array_clear
+#define array_remove_range cyx_array_remove_range
+#define array_remove_if cyx_array_remove_if
+#define array_unique_sorted cyx_array_unique_sorted
+#define array_unique_hashed cyx_array_unique_hashed
 #define array_print cyx_array_print
 #define array_map_self cyx_array_map_self
 #define array_filter_self cyx_array_filter_self
 #define array_find cyx_array_find
 #define array_find_by cyx_array_find_by
+#define array_build_eytzinger cyx_array_build_eytzinger
 
 #endif // CYLIBX_STRIP_PREFIX
 
 #ifdef CYLIBX_IMPLEMENTATION
 
 void* __cyx_array_new(struct __CyxArrayParams params) {
-	__CyxArrayHeader* arr;
-	if (!params.reserve) {
-		arr = malloc(__CYX_ARRAY_HEADER_SIZE + CYX_ARRAY_BASE_SIZE * params.__size);
-		if (!arr) { return NULL; }
-		arr->cap = CYX_ARRAY_BASE_SIZE;
-	} else {
-		arr = malloc(__CYX_ARRAY_HEADER_SIZE + params.reserve * params.__size);
-		if (!arr) { return NULL; }
-		arr->cap = params.reserve;
-	}
-	arr->size = params.__size;
-	arr->len = 0;
-	arr->is_ptr = params.is_ptr;
-	arr->print_fn = params.print_fn;
-	arr->cmp_fn = params.cmp_fn;
-	arr->defer_fn = params.defer_fn;
+	assert((!params.growth || params.growth > 1.0f) && "ERROR: The growth factor has to be greater than 1!");
+	size_t cap = params.reserve ? params.reserve : CYX_ARRAY_BASE_SIZE;
+	char is_mmap;
+	__CyxArrayHeader* arr = __cyx_mem_alloc(__CYX_ARRAY_HEADER_SIZE + cap * params.__size, params.huge_pages, &is_mmap);
+	if (!arr) { return NULL; }
+	*arr = (__CyxArrayHeader){
+		.size = params.__size,
+		.cap = cap,
+		.growth = params.growth ? params.growth : CYX_ARRAY_GROWTH,
+		.defer_fn = params.defer_fn,
+		.cmp_fn = params.cmp_fn,
+		.print_fn = params.print_fn,
+		.is_ptr = params.is_ptr,
+		.is_mmap = is_mmap,
+		.huge_pages = params.huge_pages,
+	};
 	return (void*)(arr + 1);
 }
+void* __cyx_array_new_inline(__CyxArrayHeader* storage, size_t n, struct __CyxArrayParams params) {
+	assert(storage && n);
+	assert((!params.growth || params.growth > 1.0f) && "ERROR: The growth factor has to be greater than 1!");
+	*storage = (__CyxArrayHeader){
+		.size = params.__size,
+		.cap = n,
+		.growth = params.growth ? params.growth : CYX_ARRAY_GROWTH,
+		.is_ptr = params.is_ptr,
+		.huge_pages = params.huge_pages,
+		.is_inline = 1,
+		.print_fn = params.print_fn,
+		.cmp_fn = params.cmp_fn,
+		.defer_fn = params.defer_fn,
+	};
+	return (void*)(storage + 1);
+}
 void* __cyx_array_copy(void* arr) {
 	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
 
-	void* res = malloc(__CYX_ARRAY_HEADER_SIZE + head->cap * head->size);
-	if (!res) { return NULL; }
-	__CyxArrayHeader* res_head = res;
+	char is_mmap;
+	__CyxArrayHeader* res_head = __cyx_mem_alloc(__CYX_ARRAY_HEADER_SIZE + head->cap * head->size, head->huge_pages, &is_mmap);
+	if (!res_head) { return NULL; }
 	memcpy(res_head, head, __CYX_ARRAY_HEADER_SIZE + head->len * head->size);
+	res_head->is_mmap = is_mmap;
+	res_head->is_inline = 0;
 
 	return (void*)(res_head + 1);
 }
+static void __cyx_array_defer_range(__CyxArrayHeader* head, void* arr, size_t from, size_t to) {
+	if (!head->defer_fn) { return; }
+	if (!head->is_ptr) {
+		for (size_t i = from; i < to; ++i) {
+			head->defer_fn((char*)arr + i * head->size);
+		}
+	} else {
+		for (size_t i = from; i < to; ++i) {
+			head->defer_fn(*(void**)((char*)arr + i * head->size));
+		}
+	}
+}
+void __cyx_array_realloc(void** arr_ptr, size_t cap) {
+	assert(*arr_ptr);
+
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	assert(cap >= head->len);
+	char is_mmap = head->is_mmap;
+	if (head->is_inline) {
+		// spilling out of the inline storage, which is left untouched
+		__CyxArrayHeader* new_head = __cyx_mem_alloc(__CYX_ARRAY_HEADER_SIZE + cap * head->size, head->huge_pages, &is_mmap);
+		assert(new_head && "ERROR: Could not resize the array!");
+		memcpy(new_head, head, __CYX_ARRAY_HEADER_SIZE + head->len * head->size);
+		new_head->cap = cap;
+		new_head->is_mmap = is_mmap;
+		new_head->is_inline = 0;
+		*arr_ptr = new_head + 1;
+		return;
+	}
+	__CyxArrayHeader* new_head = __cyx_mem_realloc(head,
+		__CYX_ARRAY_HEADER_SIZE + head->cap * head->size,
+		__CYX_ARRAY_HEADER_SIZE + head->len * head->size,
+		__CYX_ARRAY_HEADER_SIZE + cap * head->size,
+		head->huge_pages, &is_mmap);
+	assert(new_head && "ERROR: Could not resize the array!");
+	new_head->cap = cap;
+	new_head->is_mmap = is_mmap;
+
+	*arr_ptr = new_head + 1;
+}
 void __cyx_array_expand(void** arr_ptr, size_t n) {
 	assert(*arr_ptr);
 
 	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
 	size_t new_cap = head->cap;
-	while (n + head->len > (new_cap <<= 1));
-	__CyxArrayHeader* new_head = malloc(__CYX_ARRAY_HEADER_SIZE + new_cap * head->size);
-	memcpy(new_head, head, __CYX_ARRAY_HEADER_SIZE + head->cap * head->size);
-	new_head->cap = new_cap;
+	do {
+		size_t grown = (size_t)(new_cap * head->growth);
+		new_cap = grown > new_cap ? grown : new_cap + 1;
+	} while (n + head->len > new_cap);
 
-	free(head);
-	*arr_ptr = new_head + 1;
+	__cyx_array_realloc(arr_ptr, new_cap);
+}
+void __cyx_array_reserve(void** arr_ptr, size_t n) {
+	assert(*arr_ptr);
+	if (n > __CYX_ARRAY_GET_HEADER(*arr_ptr)->cap) { __cyx_array_realloc(arr_ptr, n); }
+}
+void __cyx_array_resize(void** arr_ptr, size_t n) {
+	assert(*arr_ptr);
+
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	if (n < head->len) {
+		__cyx_array_defer_range(head, *arr_ptr, n, head->len);
+		head->len = n;
+		return;
+	}
+	if (n > head->cap) {
+		__cyx_array_realloc(arr_ptr, n);
+		head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	}
+	memset(__CYX_DATA_GET_AT(head, *arr_ptr, head->len), 0, (n - head->len) * head->size);
+	head->len = n;
+}
+void __cyx_array_shrink_to_fit(void** arr_ptr) {
+	assert(*arr_ptr);
+
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	size_t cap = head->len ? head->len : 1;
+	if (!head->is_inline && cap < head->cap) { __cyx_array_realloc(arr_ptr, cap); }
+}
+void cyx_array_clear(void* arr) {
+	assert(arr);
+
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	__cyx_array_defer_range(head, arr, 0, head->len);
+	head->len = 0;
 }
 void __cyx_array_append(void** arr, void* val) {
 	assert(*arr);
@@ -394,6 +856,119 @@ void* __cyx_array_remove(void* arr, int pos) {
 	}
 	return ret;
 }
+void __cyx_array_insert_n_at(void** arr_ptr, size_t pos, size_t n, const void* mult) {
+	assert(*arr_ptr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	assert(pos <= head->len);
+	if (head->len + n > head->cap) {
+		__cyx_array_expand(arr_ptr, n);
+		head = __CYX_ARRAY_GET_HEADER(*arr_ptr);
+	}
+
+	char* at = __CYX_DATA_GET_AT(head, *arr_ptr, pos);
+	memmove(at + n * head->size, at, (head->len - pos) * head->size);
+	memcpy(at, mult, n * head->size);
+	head->len += n;
+}
+void* __cyx_array_remove_ordered(void* arr, int pos) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	if (pos < 0) { pos += head->len; }
+	assert(pos >= 0 && pos < (int)head->len);
+
+	char* at = __CYX_DATA_GET_AT(head, arr, pos);
+	void* ret = __cyx_temp_alloc_deleted(head->size, at, head->is_ptr, head->defer_fn);
+	memmove(at, at + head->size, (--head->len - pos) * head->size);
+	return ret;
+}
+void cyx_array_remove_range(void* arr, size_t pos, size_t n) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(pos <= head->len && n <= head->len - pos);
+
+	__cyx_array_defer_range(head, arr, pos, pos + n);
+	char* at = __CYX_DATA_GET_AT(head, arr, pos);
+	memmove(at, at + n * head->size, (head->len - pos - n) * head->size);
+	head->len -= n;
+}
+size_t cyx_array_remove_if(void* arr, int (*fn)(const void*)) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < head->len; ++i) {
+		char* curr = __CYX_DATA_GET_AT(head, arr, i);
+		if (fn(curr)) {
+			__cyx_array_defer_range(head, arr, i, i + 1);
+			continue;
+		}
+		if (kept != i) { __cyx_copy(__CYX_DATA_GET_AT(head, arr, kept), curr, head->size); }
+		++kept;
+	}
+
+	size_t removed = head->len - kept;
+	head->len = kept;
+	return removed;
+}
+// drops every element equal by `cmp_fn` to the one before it, so on a sorted array only the first of each value stays
+size_t cyx_array_unique_sorted(void* arr) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(head->cmp_fn && "ERROR: Trying to compare without a compare function provided!");
+	if (head->len < 2) { return 0; }
+
+	size_t kept = 1;
+	for (size_t i = 1; i < head->len; ++i) {
+		char* curr = __CYX_DATA_GET_AT(head, arr, i);
+		if (!__CYX_PTR_CMP(head, __CYX_DATA_GET_AT(head, arr, kept - 1), curr)) {
+			__cyx_array_defer_range(head, arr, i, i + 1);
+			continue;
+		}
+		if (kept != i) { __cyx_copy(__CYX_DATA_GET_AT(head, arr, kept), curr, head->size); }
+		++kept;
+	}
+
+	size_t removed = head->len - kept;
+	head->len = kept;
+	return removed;
+}
+// keeps the first occurrence of every value in its original order, the open addressing table only stores indices
+size_t cyx_array_unique_hashed(void* arr, size_t (*hash_fn)(const void* const), int (*eq_fn)(const void* const, const void* const)) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	if (head->len < 2) { return 0; }
+
+	size_t cap = 1;
+	while (cap < 2 * head->len) { cap <<= 1; }
+	size_t* table = calloc(cap, sizeof(size_t));
+	assert(table);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < head->len; ++i) {
+		char* curr = __CYX_DATA_GET_AT(head, arr, i);
+		const void* val = !head->is_ptr ? curr : *(void**)curr;
+		char duplicate = 0;
+		size_t pos = hash_fn(val) & (cap - 1);
+		for (; table[pos]; pos = (pos + 1) & (cap - 1)) {
+			char* other = __CYX_DATA_GET_AT(head, arr, table[pos] - 1);
+			if (eq_fn(!head->is_ptr ? other : *(void**)other, val)) {
+				duplicate = 1;
+				break;
+			}
+		}
+		if (duplicate) {
+			__cyx_array_defer_range(head, arr, i, i + 1);
+			continue;
+		}
+		if (kept != i) { __cyx_copy(__CYX_DATA_GET_AT(head, arr, kept), curr, head->size); }
+		table[pos] = ++kept;
+	}
+	free(table);
+
+	size_t removed = head->len - kept;
+	head->len = kept;
+	return removed;
+}
 void* __cyx_array_at(void* arr, int pos) {
 	if (!arr) { return NULL; }
 
@@ -407,18 +982,9 @@ void cyx_array_free(void* arr) {
 	assert(arr);
 
 	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
-	if (head->defer_fn) {
-		if (!head->is_ptr) {
-			for (size_t i = 0; i < head->len; ++i) {
-				head->defer_fn((char*)arr + i * head->size);
-			}
-		} else {
-			for (size_t i = 0; i < head->len; ++i) {
-				head->defer_fn(*(void**)((char*)arr + i * head->size));
-			}
-		}
-	}
-	free(head);
+	__cyx_array_defer_range(head, arr, 0, head->len);
+	if (head->is_inline) { return; }
+	__cyx_mem_free(head, __CYX_ARRAY_HEADER_SIZE + head->cap * head->size, head->is_mmap);
 }
 void __cyx_array_append_mult_n(void** arr_ptr, size_t n, const void* mult) {
 	void* arr = *arr_ptr;
@@ -450,39 +1016,179 @@ void cyx_array_print(const void* arr) {
 	printf(" }");
 }
 
-void __cyx_array_sort(void* arr, int start, int end) {
-	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
-	if (end - start <= 1 || end < start) {
-		if (end - start == 1 && (!head->is_ptr ?
-			head->cmp_fn((char*)arr + start * head->size, (char*)arr + (start + 1) * head->size) == 1 :
-			head->cmp_fn(*(void**)((char*)arr + start * head->size), *(void**)((char*)arr + (start + 1) * head->size)) == 1)) {
-			__CYX_SWAP((char*)arr + start * head->size, (char*)arr + (start + 1) * head->size, head->size);
-		}
-		return;
-	}
-	void* pivot = (char*)arr + end * head->size;
-	void* a = (char*)arr + (start - 1) * head->size;
-	if (!head->is_ptr) {
-		for (void* b = (char*)arr + start * head->size; b < pivot; b = (char*)b + head->size) {
-			if (head->cmp_fn(b, pivot) == -1) {
-				a = (char*)a + head->size;
-				__CYX_SWAP(a, b, head->size);
+#define __cyx_sort_less(ctx, a, b) (__CYX_PTR_CMP(ctx, a, b) < 0)
+#define __cyx_sort_at(ctx, base, pos) ((char*)(base) + (pos) * (ctx)->size)
+#define __cyx_array_sort_ctx(head) (struct __CyxSortCtx){ .size = (head)->size, .cmp_fn = (head)->cmp_fn, .is_ptr = (head)->is_ptr }
+
+static void __cyx_sort_insertion(char* base, size_t n, struct __CyxSortCtx* ctx) {
+	char tmp[__CYX_SORT_TMP_SIZE];
+	for (size_t i = 1; i < n; ++i) {
+		char* curr = __cyx_sort_at(ctx, base, i);
+		if (!__cyx_sort_less(ctx, curr, curr - ctx->size)) { continue; }
+		if (ctx->size <= __CYX_SORT_TMP_SIZE) {
+			memcpy(tmp, curr, ctx->size);
+			char* hole = curr;
+			do {
+				memcpy(hole, hole - ctx->size, ctx->size);
+				hole -= ctx->size;
+			} while (hole > base && __cyx_sort_less(ctx, tmp, hole - ctx->size));
+			memcpy(hole, tmp, ctx->size);
+		} else {
+			for (char* j = curr; j > base && __cyx_sort_less(ctx, j, j - ctx->size); j -= ctx->size) {
+				__cyx_swap(j, j - ctx->size, ctx->size);
 			}
 		}
+	}
+}
+static void __cyx_sort_sift_down(char* base, size_t root, size_t n, struct __CyxSortCtx* ctx) {
+	for (size_t child; (child = 2 * root + 1) < n; root = child) {
+		if (child + 1 < n && __cyx_sort_less(ctx, __cyx_sort_at(ctx, base, child), __cyx_sort_at(ctx, base, child + 1))) { ++child; }
+		if (!__cyx_sort_less(ctx, __cyx_sort_at(ctx, base, root), __cyx_sort_at(ctx, base, child))) { break; }
+		__cyx_swap(__cyx_sort_at(ctx, base, root), __cyx_sort_at(ctx, base, child), ctx->size);
+	}
+}
+static void __cyx_sort_heap(char* base, size_t n, struct __CyxSortCtx* ctx) {
+	for (size_t i = n / 2; i-- > 0;) { __cyx_sort_sift_down(base, i, n, ctx); }
+	for (size_t end = n - 1; end > 0; --end) {
+		__cyx_swap(base, __cyx_sort_at(ctx, base, end), ctx->size);
+		__cyx_sort_sift_down(base, 0, end, ctx);
+	}
+}
+static void __cyx_sort3(char* base, size_t a, size_t b, size_t c, struct __CyxSortCtx* ctx) {
+	char* pa = __cyx_sort_at(ctx, base, a);
+	char* pb = __cyx_sort_at(ctx, base, b);
+	char* pc = __cyx_sort_at(ctx, base, c);
+	if (__cyx_sort_less(ctx, pb, pa)) { __cyx_swap(pa, pb, ctx->size); }
+	if (__cyx_sort_less(ctx, pc, pb)) {
+		__cyx_swap(pb, pc, ctx->size);
+		if (__cyx_sort_less(ctx, pb, pa)) { __cyx_swap(pa, pb, ctx->size); }
+	}
+}
+// leaves the pivot at the start of the range, median of three or ninther for bigger ranges
+static void __cyx_sort_pivot(char* base, size_t n, struct __CyxSortCtx* ctx) {
+	size_t mid = n / 2;
+	if (n > __CYX_SORT_NINTHER_LIMIT) {
+		size_t s = n / 8;
+		__cyx_sort3(base, 0, s, 2 * s, ctx);
+		__cyx_sort3(base, mid - s, mid, mid + s, ctx);
+		__cyx_sort3(base, n - 1 - 2 * s, n - 1 - s, n - 1, ctx);
+		__cyx_sort3(base, s, mid, n - 1 - s, ctx);
 	} else {
-		for (void* b = (char*)arr + start * head->size; b < pivot; b = (char*)b + head->size) {
-			if (head->cmp_fn(*(void**)b, *(void**)pivot) == -1) {
-				a = (char*)a + head->size;
-				__CYX_SWAP(a, b, head->size);
-			}
+		__cyx_sort3(base, 0, mid, n - 1, ctx);
+	}
+	__cyx_swap(base, __cyx_sort_at(ctx, base, mid), ctx->size);
+}
+// hoare partition around the element at the start of the range, returns the final position of the pivot
+static size_t __cyx_sort_partition(char* base, size_t n, struct __CyxSortCtx* ctx) {
+	size_t i = 0, j = n;
+	for (;;) {
+		do { ++i; } while (i < n && __cyx_sort_less(ctx, __cyx_sort_at(ctx, base, i), base));
+		do { --j; } while (__cyx_sort_less(ctx, base, __cyx_sort_at(ctx, base, j)));
+		if (i >= j) { break; }
+		__cyx_swap(__cyx_sort_at(ctx, base, i), __cyx_sort_at(ctx, base, j), ctx->size);
+	}
+	__cyx_swap(base, __cyx_sort_at(ctx, base, j), ctx->size);
+	return j;
+}
+static void __cyx_introsort(char* base, size_t n, size_t depth, struct __CyxSortCtx* ctx) {
+	while (n > __CYX_SORT_INSERTION_LIMIT) {
+		if (!depth--) {
+			__cyx_sort_heap(base, n, ctx);
+			return;
+		}
+		__cyx_sort_pivot(base, n, ctx);
+		size_t mid = __cyx_sort_partition(base, n, ctx);
+
+		// recursing only into the smaller side keeps the stack depth logarithmic
+		if (mid < n - mid - 1) {
+			__cyx_introsort(base, mid, depth, ctx);
+			base = __cyx_sort_at(ctx, base, mid + 1);
+			n -= mid + 1;
+		} else {
+			__cyx_introsort(__cyx_sort_at(ctx, base, mid + 1), n - mid - 1, depth, ctx);
+			n = mid;
+		}
+	}
+	__cyx_sort_insertion(base, n, ctx);
+}
+void __cyx_sort_range(void* base, size_t n, size_t size, int (*cmp_fn)(const void*, const void*), char is_ptr) {
+	if (n < 2) { return; }
+	struct __CyxSortCtx ctx = { .size = size, .cmp_fn = cmp_fn, .is_ptr = is_ptr };
+	size_t depth = 0;
+	for (size_t i = n; i > 1; i >>= 1) { depth += 2; }
+	__cyx_introsort(base, n, depth, &ctx);
+}
+void __cyx_array_sort(void* arr) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	__cyx_sort_range(arr, head->len, head->size, head->cmp_fn, head->is_ptr);
+}
+// introselect, quickselect with the introsort pivots that falls back to heapsort when the partitions go bad
+static void __cyx_introselect(char* base, size_t n, size_t k, size_t depth, struct __CyxSortCtx* ctx) {
+	while (n > __CYX_SORT_INSERTION_LIMIT) {
+		if (!depth--) {
+			__cyx_sort_heap(base, n, ctx);
+			return;
+		}
+		__cyx_sort_pivot(base, n, ctx);
+		size_t mid = __cyx_sort_partition(base, n, ctx);
+		if (k == mid) { return; }
+		if (k < mid) {
+			n = mid;
+		} else {
+			base = __cyx_sort_at(ctx, base, mid + 1);
+			k -= mid + 1;
+			n -= mid + 1;
 		}
 	}
-	a = (char*)a + head->size;
-	int mid = ((size_t)a - (size_t)arr) / head->size;
-	__CYX_SWAP(a, pivot, head->size);
+	__cyx_sort_insertion(base, n, ctx);
+}
+void __cyx_array_nth_element(void* arr, size_t k) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	if (k >= head->len) { return; }
+	struct __CyxSortCtx ctx = __cyx_array_sort_ctx(head);
+	size_t depth = 0;
+	for (size_t i = head->len; i > 1; i >>= 1) { depth += 2; }
+	__cyx_introselect(arr, head->len, k, depth, &ctx);
+}
+void __cyx_array_partial_sort(void* arr, size_t k) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	if (k > head->len) { k = head->len; }
+	__cyx_array_nth_element(arr, k);
+	__cyx_sort_range(arr, k, head->size, head->cmp_fn, head->is_ptr);
+}
+// bounded max heap of the best `k` seen so far, one pass and O(n log k) compares
+void* __cyx_array_top_k(const void* arr, size_t k) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(head->cmp_fn && "ERROR: Trying to sort without a compare function provided!");
+	if (k > head->len) { k = head->len; }
 
-	__cyx_array_sort(arr, start, mid - 1);
-	__cyx_array_sort(arr, mid + 1, end);
+	// the result holds copies, so it does not take over `defer_fn`
+	char* res = __cyx_array_new((struct __CyxArrayParams){
+		.__size = head->size,
+		.is_ptr = head->is_ptr,
+		.reserve = k ? k : 1,
+		.print_fn = head->print_fn,
+		.cmp_fn = head->cmp_fn,
+	});
+	assert(res);
+	if (!k) { return res; }
+
+	struct __CyxSortCtx ctx = __cyx_array_sort_ctx(head);
+	memcpy(res, arr, k * head->size);
+	for (size_t i = k / 2; i-- > 0;) { __cyx_sort_sift_down(res, i, k, &ctx); }
+	for (size_t i = k; i < head->len; ++i) {
+		char* curr = __CYX_DATA_GET_AT(head, arr, i);
+		if (!__cyx_sort_less(&ctx, curr, res)) { continue; }
+		__cyx_copy(res, curr, head->size);
+		__cyx_sort_sift_down(res, 0, k, &ctx);
+	}
+	for (size_t end = k - 1; end > 0; --end) {
+		__cyx_swap(res, __cyx_sort_at(&ctx, res, end), head->size);
+		__cyx_sort_sift_down(res, 0, end, &ctx);
+	}
+	__CYX_ARRAY_GET_HEADER(res)->len = k;
+	return res;
 }
 void* __cyx_array_map(const void* const arr, void (*fn)(void*, const void*)) {
 	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
@@ -491,6 +1197,8 @@ void* __cyx_array_map(const void* const arr, void (*fn)(void*, const void*)) {
 	void* res = __cyx_array_new((struct __CyxArrayParams){
 		.__size = head->size,
 		.reserve = head->cap,
+		.growth = head->growth,
+		.huge_pages = head->huge_pages,
 		.defer_fn = head->defer_fn,
 		.print_fn = head->print_fn,
 		.cmp_fn = head->cmp_fn,
@@ -528,6 +1236,8 @@ void* __cyx_array_filter(const void* const arr, int (*fn)(const void*)) {
 		.__size = head->size,
 		.is_ptr = head->is_ptr,
 		.reserve = head->cap,
+		.growth = head->growth,
+		.huge_pages = head->huge_pages,
 		.defer_fn = head->defer_fn,
 		.print_fn = head->print_fn,
 		.cmp_fn = head->cmp_fn,
@@ -573,46 +1283,1507 @@ int cyx_array_find_by(void* arr, int (*fn)(const void*)) {
 	}
 	return -1;
 }
-void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const void*)) {
-	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
-
-	void* ret = __cyx_temp_alloc_deleted(head->size, accumulator, head->is_ptr, head->defer_fn);
-	if (head->defer_fn) { head->defer_fn(!head->is_ptr ? accumulator : *(void**)accumulator); }
-
-	for (size_t i = 0; i < head->len; ++i) { fn(ret, __CYX_DATA_GET_AT(head, arr, i)); }
+struct __CyxTimSort {
+	struct __CyxSortCtx ctx;
+	char* base;
+	char* tmp;
+	size_t tmp_cap;
+	size_t tmp_max;
+	ptrdiff_t min_gallop;
+
+	size_t runs;
+	size_t run_base[__CYX_TIMSORT_MAX_RUNS];
+	size_t run_len[__CYX_TIMSORT_MAX_RUNS];
+};
 
-	return ret;
+#define __cyx_ts_at(ts, ptr, pos) __cyx_sort_at(&(ts)->ctx, ptr, pos)
+#define __cyx_ts_less(ts, a, b) __cyx_sort_less(&(ts)->ctx, a, b)
+
+static size_t __cyx_ts_count_run(struct __CyxTimSort* ts, size_t lo, size_t hi) {
+	size_t run_hi = lo + 1;
+	if (run_hi == hi) { return 1; }
+	if (__cyx_ts_less(ts, __cyx_ts_at(ts, ts->base, run_hi), __cyx_ts_at(ts, ts->base, lo))) {
+		++run_hi;
+		while (run_hi < hi && __cyx_ts_less(ts, __cyx_ts_at(ts, ts->base, run_hi), __cyx_ts_at(ts, ts->base, run_hi - 1))) { ++run_hi; }
+		// only strictly descending runs get reversed so the sort stays stable
+		for (size_t l = lo, r = run_hi - 1; l < r; ++l, --r) {
+			__cyx_swap(__cyx_ts_at(ts, ts->base, l), __cyx_ts_at(ts, ts->base, r), ts->ctx.size);
+		}
+	} else {
+		++run_hi;
+		while (run_hi < hi && !__cyx_ts_less(ts, __cyx_ts_at(ts, ts->base, run_hi), __cyx_ts_at(ts, ts->base, run_hi - 1))) { ++run_hi; }
+	}
+	return run_hi - lo;
 }
-
-#endif // CYLIBX_IMPLEMENTATION
-
-#endif // __CYX_CLOSE_FOLD
-
-/*
- * Bitmap
- */
-
-#if __CYX_CLOSE_FOLD
-
-#define cyx_bitmap_size(bitmap) (*(bitmap - 1))
-
-size_t* cyx_bitmap_new(size_t size);
-size_t* cyx_bitmap_copy(const size_t* const bitmap);
-int cyx_bitmap_get(const size_t* const bitmap, int pos);
-void cyx_bitmap_flip(size_t* bitmap, int pos);
-void cyx_bitmap_set(size_t* bitmap, int pos, int val);
+static void __cyx_ts_binary_sort(struct __CyxTimSort* ts, size_t lo, size_t hi, size_t start) {
+	char pivot[__CYX_SORT_TMP_SIZE];
+	char* p = ts->ctx.size <= __CYX_SORT_TMP_SIZE ? pivot : malloc(ts->ctx.size);
+	assert(p);
+	for (; start < hi; ++start) {
+		memcpy(p, __cyx_ts_at(ts, ts->base, start), ts->ctx.size);
+		size_t left = lo, right = start;
+		while (left < right) {
+			size_t mid = left + (right - left) / 2;
+			if (__cyx_ts_less(ts, p, __cyx_ts_at(ts, ts->base, mid))) { right = mid; } else { left = mid + 1; }
+		}
+		memmove(__cyx_ts_at(ts, ts->base, left + 1), __cyx_ts_at(ts, ts->base, left), (start - left) * ts->ctx.size);
+		memcpy(__cyx_ts_at(ts, ts->base, left), p, ts->ctx.size);
+	}
+	if (p != pivot) { free(p); }
+}
+// position of the first element in `a` that is not less than `key`
+static size_t __cyx_ts_gallop_left(struct __CyxTimSort* ts, const void* key, char* a, size_t len, size_t hint) {
+	ptrdiff_t last_ofs = 0, ofs = 1;
+	if (__cyx_ts_less(ts, __cyx_ts_at(ts, a, hint), key)) {
+		ptrdiff_t max_ofs = len - hint;
+		while (ofs < max_ofs && __cyx_ts_less(ts, __cyx_ts_at(ts, a, hint + ofs), key)) {
+			last_ofs = ofs;
+			ofs = (ofs << 1) + 1;
+		}
+		if (ofs > max_ofs) { ofs = max_ofs; }
+		last_ofs += hint;
+		ofs += hint;
+	} else {
+		ptrdiff_t max_ofs = hint + 1;
+		while (ofs < max_ofs && !__cyx_ts_less(ts, __cyx_ts_at(ts, a, hint - ofs), key)) {
+			last_ofs = ofs;
+			ofs = (ofs << 1) + 1;
+		}
+		if (ofs > max_ofs) { ofs = max_ofs; }
+		ptrdiff_t tmp = last_ofs;
+		last_ofs = hint - ofs;
+		ofs = hint - tmp;
+	}
+	++last_ofs;
+	while (last_ofs < ofs) {
+		ptrdiff_t mid = last_ofs + ((ofs - last_ofs) >> 1);
+		if (__cyx_ts_less(ts, __cyx_ts_at(ts, a, mid), key)) { last_ofs = mid + 1; } else { ofs = mid; }
+	}
+	return ofs;
+}
+// position of the first element in `a` that is greater than `key`
+static size_t __cyx_ts_gallop_right(struct __CyxTimSort* ts, const void* key, char* a, size_t len, size_t hint) {
+	ptrdiff_t last_ofs = 0, ofs = 1;
+	if (__cyx_ts_less(ts, key, __cyx_ts_at(ts, a, hint))) {
+		ptrdiff_t max_ofs = hint + 1;
+		while (ofs < max_ofs && __cyx_ts_less(ts, key, __cyx_ts_at(ts, a, hint - ofs))) {
+			last_ofs = ofs;
+			ofs = (ofs << 1) + 1;
+		}
+		if (ofs > max_ofs) { ofs = max_ofs; }
+		ptrdiff_t tmp = last_ofs;
+		last_ofs = hint - ofs;
+		ofs = hint - tmp;
+	} else {
+		ptrdiff_t max_ofs = len - hint;
+		while (ofs < max_ofs && !__cyx_ts_less(ts, key, __cyx_ts_at(ts, a, hint + ofs))) {
+			last_ofs = ofs;
+			ofs = (ofs << 1) + 1;
+		}
+		if (ofs > max_ofs) { ofs = max_ofs; }
+		last_ofs += hint;
+		ofs += hint;
+	}
+	++last_ofs;
+	while (last_ofs < ofs) {
+		ptrdiff_t mid = last_ofs + ((ofs - last_ofs) >> 1);
+		if (__cyx_ts_less(ts, key, __cyx_ts_at(ts, a, mid))) { ofs = mid; } else { last_ofs = mid + 1; }
+	}
+	return ofs;
+}
+static char* __cyx_ts_tmp(struct __CyxTimSort* ts, size_t n) {
+	if (ts->tmp_cap < n) {
+		size_t cap = ts->tmp_cap ? ts->tmp_cap : 256;
+		while (cap < n) { cap <<= 1; }
+		// a merge never needs more than the smaller of the two runs, so n / 2 elements at most
+		if (cap > ts->tmp_max) { cap = ts->tmp_max; }
+		free(ts->tmp);
+		ts->tmp = malloc(cap * ts->ctx.size);
+		assert(ts->tmp);
+		ts->tmp_cap = cap;
+	}
+	return ts->tmp;
+}
+static void __cyx_ts_merge_lo(struct __CyxTimSort* ts, size_t base1, size_t len1, size_t base2, size_t len2) {
+	size_t size = ts->ctx.size;
+	char* a = ts->base;
+	char* tmp = __cyx_ts_tmp(ts, len1);
+	memcpy(tmp, __cyx_ts_at(ts, a, base1), len1 * size);
+
+	size_t cursor1 = 0, cursor2 = base2, dest = base1;
+	__cyx_copy(__cyx_ts_at(ts, a, dest++), __cyx_ts_at(ts, a, cursor2++), size);
+	if (--len2 == 0) {
+		memcpy(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, tmp, cursor1), len1 * size);
+		return;
+	}
+	if (len1 == 1) {
+		memmove(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, a, cursor2), len2 * size);
+		__cyx_copy(__cyx_ts_at(ts, a, dest + len2), __cyx_ts_at(ts, tmp, cursor1), size);
+		return;
+	}
+
+	ptrdiff_t min_gallop = ts->min_gallop;
+	for (;;) {
+		size_t count1 = 0, count2 = 0;
+		do {
+			if (__cyx_ts_less(ts, __cyx_ts_at(ts, a, cursor2), __cyx_ts_at(ts, tmp, cursor1))) {
+				__cyx_copy(__cyx_ts_at(ts, a, dest++), __cyx_ts_at(ts, a, cursor2++), size);
+				++count2;
+				count1 = 0;
+				if (--len2 == 0) { goto done; }
+			} else {
+				__cyx_copy(__cyx_ts_at(ts, a, dest++), __cyx_ts_at(ts, tmp, cursor1++), size);
+				++count1;
+				count2 = 0;
+				if (--len1 == 1) { goto done; }
+			}
+		} while ((ptrdiff_t)(count1 | count2) < min_gallop);
+
+		do {
+			count1 = __cyx_ts_gallop_right(ts, __cyx_ts_at(ts, a, cursor2), __cyx_ts_at(ts, tmp, cursor1), len1, 0);
+			if (count1) {
+				memcpy(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, tmp, cursor1), count1 * size);
+				dest += count1;
+				cursor1 += count1;
+				len1 -= count1;
+				if (len1 <= 1) { goto done; }
+			}
+			__cyx_copy(__cyx_ts_at(ts, a, dest++), __cyx_ts_at(ts, a, cursor2++), size);
+			if (--len2 == 0) { goto done; }
+
+			count2 = __cyx_ts_gallop_left(ts, __cyx_ts_at(ts, tmp, cursor1), __cyx_ts_at(ts, a, cursor2), len2, 0);
+			if (count2) {
+				memmove(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, a, cursor2), count2 * size);
+				dest += count2;
+				cursor2 += count2;
+				len2 -= count2;
+				if (len2 == 0) { goto done; }
+			}
+			__cyx_copy(__cyx_ts_at(ts, a, dest++), __cyx_ts_at(ts, tmp, cursor1++), size);
+			if (--len1 == 1) { goto done; }
+			--min_gallop;
+		} while (count1 >= __CYX_TIMSORT_MIN_GALLOP || count2 >= __CYX_TIMSORT_MIN_GALLOP);
+		if (min_gallop < 0) { min_gallop = 0; }
+		min_gallop += 2;
+	}
+done:
+	ts->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+	if (len1 == 1) {
+		memmove(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, a, cursor2), len2 * size);
+		__cyx_copy(__cyx_ts_at(ts, a, dest + len2), __cyx_ts_at(ts, tmp, cursor1), size);
+	} else {
+		assert(len1 && "ERROR: Compare function is not consistent!");
+		memcpy(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, tmp, cursor1), len1 * size);
+	}
+}
+static void __cyx_ts_merge_hi(struct __CyxTimSort* ts, size_t base1, size_t len1, size_t base2, size_t len2) {
+	size_t size = ts->ctx.size;
+	char* a = ts->base;
+	char* tmp = __cyx_ts_tmp(ts, len2);
+	memcpy(tmp, __cyx_ts_at(ts, a, base2), len2 * size);
+
+	// cursors run backwards and can step one past the start of their run
+	ptrdiff_t cursor1 = base1 + len1 - 1, cursor2 = len2 - 1, dest = base2 + len2 - 1;
+	__cyx_copy(__cyx_ts_at(ts, a, dest--), __cyx_ts_at(ts, a, cursor1--), size);
+	if (--len1 == 0) {
+		memcpy(__cyx_ts_at(ts, a, dest - (len2 - 1)), tmp, len2 * size);
+		return;
+	}
+	if (len2 == 1) {
+		dest -= len1;
+		cursor1 -= len1;
+		memmove(__cyx_ts_at(ts, a, dest + 1), __cyx_ts_at(ts, a, cursor1 + 1), len1 * size);
+		__cyx_copy(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, tmp, cursor2), size);
+		return;
+	}
+
+	ptrdiff_t min_gallop = ts->min_gallop;
+	for (;;) {
+		size_t count1 = 0, count2 = 0;
+		do {
+			if (__cyx_ts_less(ts, __cyx_ts_at(ts, tmp, cursor2), __cyx_ts_at(ts, a, cursor1))) {
+				__cyx_copy(__cyx_ts_at(ts, a, dest--), __cyx_ts_at(ts, a, cursor1--), size);
+				++count1;
+				count2 = 0;
+				if (--len1 == 0) { goto done; }
+			} else {
+				__cyx_copy(__cyx_ts_at(ts, a, dest--), __cyx_ts_at(ts, tmp, cursor2--), size);
+				++count2;
+				count1 = 0;
+				if (--len2 == 1) { goto done; }
+			}
+		} while ((ptrdiff_t)(count1 | count2) < min_gallop);
+
+		do {
+			count1 = len1 - __cyx_ts_gallop_right(ts, __cyx_ts_at(ts, tmp, cursor2), __cyx_ts_at(ts, a, base1), len1, len1 - 1);
+			if (count1) {
+				dest -= count1;
+				cursor1 -= count1;
+				len1 -= count1;
+				memmove(__cyx_ts_at(ts, a, dest + 1), __cyx_ts_at(ts, a, cursor1 + 1), count1 * size);
+				if (len1 == 0) { goto done; }
+			}
+			__cyx_copy(__cyx_ts_at(ts, a, dest--), __cyx_ts_at(ts, tmp, cursor2--), size);
+			if (--len2 == 1) { goto done; }
+
+			count2 = len2 - __cyx_ts_gallop_left(ts, __cyx_ts_at(ts, a, cursor1), tmp, len2, len2 - 1);
+			if (count2) {
+				dest -= count2;
+				cursor2 -= count2;
+				len2 -= count2;
+				memcpy(__cyx_ts_at(ts, a, dest + 1), __cyx_ts_at(ts, tmp, cursor2 + 1), count2 * size);
+				if (len2 <= 1) { goto done; }
+			}
+			__cyx_copy(__cyx_ts_at(ts, a, dest--), __cyx_ts_at(ts, a, cursor1--), size);
+			if (--len1 == 0) { goto done; }
+			--min_gallop;
+		} while (count1 >= __CYX_TIMSORT_MIN_GALLOP || count2 >= __CYX_TIMSORT_MIN_GALLOP);
+		if (min_gallop < 0) { min_gallop = 0; }
+		min_gallop += 2;
+	}
+done:
+	ts->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+	if (len2 == 1) {
+		dest -= len1;
+		cursor1 -= len1;
+		memmove(__cyx_ts_at(ts, a, dest + 1), __cyx_ts_at(ts, a, cursor1 + 1), len1 * size);
+		__cyx_copy(__cyx_ts_at(ts, a, dest), __cyx_ts_at(ts, tmp, cursor2), size);
+	} else {
+		assert(len2 && "ERROR: Compare function is not consistent!");
+		memcpy(__cyx_ts_at(ts, a, dest - (len2 - 1)), tmp, len2 * size);
+	}
+}
+static void __cyx_ts_merge_at(struct __CyxTimSort* ts, size_t i) {
+	size_t base1 = ts->run_base[i], len1 = ts->run_len[i];
+	size_t base2 = ts->run_base[i + 1], len2 = ts->run_len[i + 1];
+
+	ts->run_len[i] = len1 + len2;
+	if (i == ts->runs - 3) {
+		ts->run_base[i + 1] = ts->run_base[i + 2];
+		ts->run_len[i + 1] = ts->run_len[i + 2];
+	}
+	--ts->runs;
+
+	// elements of run1 that are already in place and elements of run2 that are already in place are skipped
+	size_t k = __cyx_ts_gallop_right(ts, __cyx_ts_at(ts, ts->base, base2), __cyx_ts_at(ts, ts->base, base1), len1, 0);
+	base1 += k;
+	len1 -= k;
+	if (!len1) { return; }
+	len2 = __cyx_ts_gallop_left(ts, __cyx_ts_at(ts, ts->base, base1 + len1 - 1), __cyx_ts_at(ts, ts->base, base2), len2, len2 - 1);
+	if (!len2) { return; }
+
+	if (len1 <= len2) {
+		__cyx_ts_merge_lo(ts, base1, len1, base2, len2);
+	} else {
+		__cyx_ts_merge_hi(ts, base1, len1, base2, len2);
+	}
+}
+static void __cyx_ts_merge_collapse(struct __CyxTimSort* ts) {
+	while (ts->runs > 1) {
+		size_t n = ts->runs - 2;
+		size_t* len = ts->run_len;
+		if ((n > 0 && len[n - 1] <= len[n] + len[n + 1]) || (n > 1 && len[n - 2] <= len[n] + len[n - 1])) {
+			if (len[n - 1] < len[n + 1]) { --n; }
+		} else if (len[n] > len[n + 1]) {
+			break;
+		}
+		__cyx_ts_merge_at(ts, n);
+	}
+}
+void __cyx_sort_stable_range(void* base, size_t n, size_t size, int (*cmp_fn)(const void*, const void*), char is_ptr) {
+	if (n < 2) { return; }
+	struct __CyxTimSort ts = {
+		.ctx = { .size = size, .cmp_fn = cmp_fn, .is_ptr = is_ptr },
+		.base = base,
+		.tmp_max = n / 2,
+		.min_gallop = __CYX_TIMSORT_MIN_GALLOP,
+	};
+
+	if (n < __CYX_TIMSORT_MIN_MERGE) {
+		__cyx_ts_binary_sort(&ts, 0, n, __cyx_ts_count_run(&ts, 0, n));
+		return;
+	}
+
+	size_t min_run = n, odd = 0;
+	while (min_run >= __CYX_TIMSORT_MIN_MERGE) {
+		odd |= min_run & 1;
+		min_run >>= 1;
+	}
+	min_run += odd;
+
+	for (size_t lo = 0; lo < n;) {
+		size_t run = __cyx_ts_count_run(&ts, lo, n);
+		if (run < min_run) {
+			size_t force = n - lo < min_run ? n - lo : min_run;
+			__cyx_ts_binary_sort(&ts, lo, lo + force, lo + run);
+			run = force;
+		}
+		ts.run_base[ts.runs] = lo;
+		ts.run_len[ts.runs] = run;
+		++ts.runs;
+		__cyx_ts_merge_collapse(&ts);
+		lo += run;
+	}
+	while (ts.runs > 1) {
+		size_t i = ts.runs - 2;
+		if (i > 0 && ts.run_len[i - 1] < ts.run_len[i + 1]) { --i; }
+		__cyx_ts_merge_at(&ts, i);
+	}
+
+	free(ts.tmp);
+}
+void __cyx_array_sort_stable(void* arr) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	__cyx_sort_stable_range(arr, head->len, head->size, head->cmp_fn, head->is_ptr);
+}
+
+#undef __cyx_ts_at
+#undef __cyx_ts_less
+size_t __cyx_lower_bound(const void* base, size_t n, const void* val, struct __CyxSortCtx* ctx) {
+	size_t lo = 0;
+	while (n) {
+		size_t half = n / 2;
+		if (__cyx_sort_less(ctx, __cyx_sort_at(ctx, base, lo + half), val)) {
+			lo += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return lo;
+}
+size_t __cyx_upper_bound(const void* base, size_t n, const void* val, struct __CyxSortCtx* ctx) {
+	size_t lo = 0;
+	while (n) {
+		size_t half = n / 2;
+		if (!__cyx_sort_less(ctx, val, __cyx_sort_at(ctx, base, lo + half))) {
+			lo += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return lo;
+}
+int __cyx_array_bsearch(void* arr, const void* val) {
+	size_t pos = __cyx_array_lower_bound(arr, val);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	if (pos == head->len || __CYX_PTR_CMP(head, val, __CYX_DATA_GET_AT(head, arr, pos))) { return -1; }
+	return (int)pos;
+}
+size_t __cyx_array_lower_bound(void* arr, const void* val) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(head->cmp_fn && "ERROR: Trying to search without a compare function provided!");
+	struct __CyxSortCtx ctx = __cyx_array_sort_ctx(head);
+	return __cyx_lower_bound(arr, head->len, val, &ctx);
+}
+size_t __cyx_array_upper_bound(void* arr, const void* val) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(head->cmp_fn && "ERROR: Trying to search without a compare function provided!");
+	struct __CyxSortCtx ctx = __cyx_array_sort_ctx(head);
+	return __cyx_upper_bound(arr, head->len, val, &ctx);
+}
+// in-order walk of the implicit tree, node `k` (1 based) lands at `k - 1`
+static size_t __cyx_eytzinger_fill(const char* src, char* dst, size_t i, size_t k, size_t n, size_t size) {
+	if (k <= n) {
+		i = __cyx_eytzinger_fill(src, dst, i, 2 * k, n, size);
+		memcpy(dst + (k - 1) * size, src + i++ * size, size);
+		i = __cyx_eytzinger_fill(src, dst, i, 2 * k + 1, n, size);
+	}
+	return i;
+}
+void* cyx_array_build_eytzinger(void* arr) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+
+	void* res = __cyx_array_new((struct __CyxArrayParams){
+		.__size = head->size,
+		.is_ptr = head->is_ptr,
+		.reserve = head->len ? head->len : 1,
+		.growth = head->growth,
+		.huge_pages = head->huge_pages,
+		.print_fn = head->print_fn,
+		.cmp_fn = head->cmp_fn,
+	});
+	assert(res);
+	__cyx_eytzinger_fill(arr, res, 0, 1, head->len, head->size);
+	__CYX_ARRAY_GET_HEADER(res)->len = head->len;
+	return res;
+}
+int __cyx_array_eytzinger_lower_bound(void* eyt, const void* val) {
+	assert(eyt);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(eyt);
+	assert(head->cmp_fn && "ERROR: Trying to search without a compare function provided!");
+	struct __CyxSortCtx ctx = __cyx_array_sort_ctx(head);
+
+	// descendants four levels down share a cache line for small elements, fetch it while comparing
+	size_t line = 1;
+	while (2 * line * head->size <= 64) { line <<= 1; }
+	uintptr_t base = (uintptr_t)eyt - head->size;
+	size_t k = 1;
+	while (k <= head->len) {
+		__builtin_prefetch((const void*)(base + k * line * head->size));
+		k = 2 * k + __cyx_sort_less(&ctx, (char*)base + k * head->size, val);
+	}
+	k >>= __builtin_ffsll(~(long long)k);
+	return k ? (int)k - 1 : -1;
+}
+int __cyx_array_eytzinger_bsearch(void* eyt, const void* val) {
+	int pos = __cyx_array_eytzinger_lower_bound(eyt, val);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(eyt);
+	if (pos < 0 || __CYX_PTR_CMP(head, val, __CYX_DATA_GET_AT(head, eyt, pos))) { return -1; }
+	return pos;
+}
+
+struct __CyxParallelSortCtx {
+	char* arr;
+	char* scratch;
+	struct __CyxSortCtx sort;
+
+	size_t nchunks;
+	size_t* chunk_start;
+	size_t* bounds;
+	size_t* out_start;
+};
+
+#define __cyx_psort_bound(ctx, chunk, part) ((ctx)->bounds[(chunk) * ((ctx)->nchunks + 1) + (part)])
+
+static void __cyx_psort_chunk(struct __CyxThreadTask* task) {
+	struct __CyxParallelSortCtx* ctx = task->ctx;
+	ctx->chunk_start[task->id] = task->start;
+	__cyx_sort_range(__cyx_sort_at(&ctx->sort, ctx->arr, task->start), task->end - task->start, ctx->sort.size, ctx->sort.cmp_fn, ctx->sort.is_ptr);
+}
+static void __cyx_psort_heap_down(struct __CyxParallelSortCtx* ctx, size_t* heap, size_t len, const size_t* cur, size_t pos) {
+	for (size_t child; (child = 2 * pos + 1) < len; pos = child) {
+		if (child + 1 < len && __cyx_sort_less(&ctx->sort,
+				__cyx_sort_at(&ctx->sort, ctx->arr, cur[heap[child + 1]]),
+				__cyx_sort_at(&ctx->sort, ctx->arr, cur[heap[child]]))) { ++child; }
+		if (!__cyx_sort_less(&ctx->sort,
+				__cyx_sort_at(&ctx->sort, ctx->arr, cur[heap[child]]),
+				__cyx_sort_at(&ctx->sort, ctx->arr, cur[heap[pos]]))) { break; }
+		size_t tmp = heap[pos];
+		heap[pos] = heap[child];
+		heap[child] = tmp;
+	}
+}
+// merges partition `task->id` of every sorted chunk into its place in the scratch buffer
+static void __cyx_psort_merge(struct __CyxThreadTask* task) {
+	struct __CyxParallelSortCtx* ctx = task->ctx;
+	size_t k = ctx->nchunks;
+	size_t* cur = malloc(3 * k * sizeof(size_t));
+	assert(cur);
+	size_t* end = cur + k;
+	size_t* heap = end + k;
+
+	size_t len = 0;
+	for (size_t c = 0; c < k; ++c) {
+		cur[c] = __cyx_psort_bound(ctx, c, task->id);
+		end[c] = __cyx_psort_bound(ctx, c, task->id + 1);
+		if (cur[c] < end[c]) { heap[len++] = c; }
+	}
+	for (size_t i = len / 2; i-- > 0;) { __cyx_psort_heap_down(ctx, heap, len, cur, i); }
+
+	char* out = __cyx_sort_at(&ctx->sort, ctx->scratch, ctx->out_start[task->id]);
+	while (len) {
+		size_t c = heap[0];
+		__cyx_copy(out, __cyx_sort_at(&ctx->sort, ctx->arr, cur[c]), ctx->sort.size);
+		out += ctx->sort.size;
+		if (++cur[c] == end[c]) { heap[0] = heap[--len]; }
+		__cyx_psort_heap_down(ctx, heap, len, cur, 0);
+	}
+	free(cur);
+}
+static void __cyx_psort_copy_back(struct __CyxThreadTask* task) {
+	struct __CyxParallelSortCtx* ctx = task->ctx;
+	memcpy(__cyx_sort_at(&ctx->sort, ctx->arr, task->start), __cyx_sort_at(&ctx->sort, ctx->scratch, task->start), (task->end - task->start) * ctx->sort.size);
+}
+void __cyx_array_sort_parallel(void* arr, size_t nthreads) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	size_t k = __cyx_thread_count(nthreads, head->len / __CYX_SORT_PARALLEL_MIN);
+	if (k < 2) {
+		__cyx_array_sort(arr);
+		return;
+	}
+
+	struct __CyxParallelSortCtx ctx = {
+		.arr = arr,
+		.scratch = malloc(head->len * head->size),
+		.sort = { .size = head->size, .cmp_fn = head->cmp_fn, .is_ptr = head->is_ptr },
+		.nchunks = k,
+		.chunk_start = malloc((k + 1) * sizeof(size_t)),
+		.bounds = malloc(k * (k + 1) * sizeof(size_t)),
+		.out_start = malloc((k + 1) * sizeof(size_t)),
+	};
+	char* samples = malloc(k * k * head->size);
+	assert(ctx.scratch && ctx.chunk_start && ctx.bounds && ctx.out_start && samples);
+
+	__cyx_parallel_run(k, head->len, __cyx_psort_chunk, &ctx);
+	ctx.chunk_start[k] = head->len;
+
+	// regular sampling: k evenly spaced samples from every sorted chunk give k - 1 splitters
+	for (size_t c = 0; c < k; ++c) {
+		size_t chunk_len = ctx.chunk_start[c + 1] - ctx.chunk_start[c];
+		for (size_t s = 0; s < k; ++s) {
+			memcpy(samples + (c * k + s) * head->size, __cyx_sort_at(&ctx.sort, arr, ctx.chunk_start[c] + s * chunk_len / k), head->size);
+		}
+	}
+	__cyx_sort_range(samples, k * k, head->size, head->cmp_fn, head->is_ptr);
+
+	for (size_t c = 0; c < k; ++c) {
+		size_t chunk_len = ctx.chunk_start[c + 1] - ctx.chunk_start[c];
+		char* chunk = __cyx_sort_at(&ctx.sort, arr, ctx.chunk_start[c]);
+		__cyx_psort_bound(&ctx, c, 0) = ctx.chunk_start[c];
+		for (size_t p = 1; p < k; ++p) {
+			__cyx_psort_bound(&ctx, c, p) = ctx.chunk_start[c] + __cyx_lower_bound(chunk, chunk_len, samples + p * k * head->size, &ctx.sort);
+		}
+		__cyx_psort_bound(&ctx, c, k) = ctx.chunk_start[c + 1];
+	}
+	ctx.out_start[0] = 0;
+	for (size_t p = 0; p < k; ++p) {
+		ctx.out_start[p + 1] = ctx.out_start[p];
+		for (size_t c = 0; c < k; ++c) { ctx.out_start[p + 1] += __cyx_psort_bound(&ctx, c, p + 1) - __cyx_psort_bound(&ctx, c, p); }
+	}
+
+	__cyx_parallel_run(k, k, __cyx_psort_merge, &ctx);
+	__cyx_parallel_run(k, head->len, __cyx_psort_copy_back, &ctx);
+
+	free(samples);
+	free(ctx.out_start);
+	free(ctx.bounds);
+	free(ctx.chunk_start);
+	free(ctx.scratch);
+}
+
+#undef __cyx_psort_bound
+static inline uint64_t __cyx_radix_key(const void* val, CyxKeyType key_type) {
+	uint32_t k32;
+	uint64_t k64;
+	switch (key_type) {
+	case CYX_KEY_U32: memcpy(&k32, val, 4); return k32;
+	case CYX_KEY_I32: memcpy(&k32, val, 4); return k32 ^ 0x80000000u;
+	case CYX_KEY_F32: memcpy(&k32, val, 4); return k32 & 0x80000000u ? ~k32 : k32 | 0x80000000u;
+	case CYX_KEY_U64: memcpy(&k64, val, 8); return k64;
+	case CYX_KEY_I64: memcpy(&k64, val, 8); return k64 ^ 0x8000000000000000ull;
+	case CYX_KEY_F64: memcpy(&k64, val, 8); return k64 & 0x8000000000000000ull ? ~k64 : k64 | 0x8000000000000000ull;
+	}
+	return 0;
+}
+void __cyx_array_sort_radix(void* arr, CyxKeyType key_type, size_t key_offset) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	assert(!head->is_ptr && "ERROR: Radix sort needs the keys to be stored inside of the array!");
+	size_t key_bytes = key_type == CYX_KEY_U32 || key_type == CYX_KEY_I32 || key_type == CYX_KEY_F32 ? 4 : 8;
+	assert(key_offset + key_bytes <= head->size && "ERROR: Radix key is outside of the array element!");
+	if (head->len < 2) { return; }
+
+	size_t (*counts)[256] = calloc(key_bytes, sizeof(*counts));
+	void* scratch = malloc(head->len * head->size);
+	assert(counts && scratch);
+
+	for (size_t i = 0; i < head->len; ++i) {
+		uint64_t key = __cyx_radix_key(__CYX_DATA_GET_AT(head, arr, i) + key_offset, key_type);
+		for (size_t b = 0; b < key_bytes; ++b) { ++counts[b][(key >> (8 * b)) & 0xff]; }
+	}
+
+	char* src = arr;
+	char* dst = scratch;
+	uint64_t first_key = __cyx_radix_key(src + key_offset, key_type);
+	for (size_t b = 0; b < key_bytes; ++b) {
+		// every key shares this byte so the pass would not move anything
+		if (counts[b][(first_key >> (8 * b)) & 0xff] == head->len) { continue; }
+
+		size_t offset = 0;
+		for (size_t d = 0; d < 256; ++d) {
+			size_t count = counts[b][d];
+			counts[b][d] = offset;
+			offset += count;
+		}
+		for (size_t i = 0; i < head->len; ++i) {
+			char* val = src + i * head->size;
+			uint64_t key = __cyx_radix_key(val + key_offset, key_type);
+			__cyx_copy(dst + counts[b][(key >> (8 * b)) & 0xff]++ * head->size, val, head->size);
+		}
+
+		char* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != arr) { memcpy(arr, src, head->len * head->size); }
+
+	free(scratch);
+	free(counts);
+}
+void* __cyx_array_fold(void* arr, void* accumulator, void (*fn)(void*, const void*)) {
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+
+	void* ret = __cyx_temp_alloc_deleted(head->size, accumulator, head->is_ptr, head->defer_fn);
+	if (head->defer_fn) { head->defer_fn(!head->is_ptr ? accumulator : *(void**)accumulator); }
+
+	for (size_t i = 0; i < head->len; ++i) { fn(ret, __CYX_DATA_GET_AT(head, arr, i)); }
+
+	return ret;
+}
+
+struct __CyxParallelArrayCtx {
+	const char* arr;
+	char* res;
+	__CyxArrayHeader* head;
+	size_t stride;
+
+	void (*map_fn)(void*, const void*);
+	int (*filter_fn)(const void*);
+	void (*fold_fn)(void*, const void*);
+
+	size_t starts[CYX_THREADS_MAX];
+	size_t counts[CYX_THREADS_MAX];
+};
+
+static void* __cyx_array_new_like(__CyxArrayHeader* head, size_t cap) {
+	void* res = __cyx_array_new((struct __CyxArrayParams){
+		.__size = head->size,
+		.is_ptr = head->is_ptr,
+		.reserve = cap ? cap : 1,
+		.growth = head->growth,
+		.huge_pages = head->huge_pages,
+		.defer_fn = head->defer_fn,
+		.print_fn = head->print_fn,
+		.cmp_fn = head->cmp_fn,
+	});
+	assert(res);
+	return res;
+}
+static void __cyx_array_map_task(struct __CyxThreadTask* task) {
+	struct __CyxParallelArrayCtx* ctx = task->ctx;
+	size_t size = ctx->head->size;
+	for (size_t i = task->start; i < task->end; ++i) { ctx->map_fn(ctx->res + i * size, ctx->arr + i * size); }
+}
+void* __cyx_array_map_par(const void* const arr, void (*fn)(void*, const void*), size_t nthreads) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	struct __CyxParallelArrayCtx ctx = { .arr = arr, .head = head, .map_fn = fn };
+	ctx.res = __cyx_array_new_like(head, head->len);
+
+	nthreads = __cyx_thread_count(nthreads, (head->len + __CYX_PARALLEL_GRAIN - 1) / __CYX_PARALLEL_GRAIN);
+	__cyx_parallel_run(nthreads, head->len, __cyx_array_map_task, &ctx);
+	__CYX_ARRAY_GET_HEADER(ctx.res)->len = head->len;
+	return ctx.res;
+}
+// every thread compacts its chunk in place inside the result, the chunks are then slid together in order
+static void __cyx_array_filter_task(struct __CyxThreadTask* task) {
+	struct __CyxParallelArrayCtx* ctx = task->ctx;
+	size_t size = ctx->head->size;
+	size_t count = 0;
+	for (size_t i = task->start; i < task->end; ++i) {
+		if (ctx->filter_fn(ctx->arr + i * size)) {
+			__cyx_copy(ctx->res + (task->start + count++) * size, ctx->arr + i * size, size);
+		}
+	}
+	ctx->starts[task->id] = task->start;
+	ctx->counts[task->id] = count;
+}
+void* __cyx_array_filter_par(const void* const arr, int (*fn)(const void*), size_t nthreads) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	struct __CyxParallelArrayCtx ctx = { .arr = arr, .head = head, .filter_fn = fn };
+	ctx.res = __cyx_array_new_like(head, head->len);
+
+	nthreads = __cyx_thread_count(nthreads, (head->len + __CYX_PARALLEL_GRAIN - 1) / __CYX_PARALLEL_GRAIN);
+	__cyx_parallel_run(nthreads, head->len, __cyx_array_filter_task, &ctx);
+
+	size_t len = 0;
+	for (size_t t = 0; t < nthreads; ++t) {
+		if (len != ctx.starts[t]) {
+			memmove(ctx.res + len * head->size, ctx.res + ctx.starts[t] * head->size, ctx.counts[t] * head->size);
+		}
+		len += ctx.counts[t];
+	}
+	__CYX_ARRAY_GET_HEADER(ctx.res)->len = len;
+	return ctx.res;
+}
+static void __cyx_array_fold_task(struct __CyxThreadTask* task) {
+	struct __CyxParallelArrayCtx* ctx = task->ctx;
+	size_t size = ctx->head->size;
+	char* acc = ctx->res + task->id * ctx->stride;
+	for (size_t i = task->start; i < task->end; ++i) { ctx->fold_fn(acc, ctx->arr + i * size); }
+}
+void* __cyx_array_fold_par(void* arr, void* accumulator, void (*fn)(void*, const void*), void (*combine_fn)(void*, const void*), size_t nthreads) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	nthreads = __cyx_thread_count(nthreads, (head->len + __CYX_PARALLEL_GRAIN - 1) / __CYX_PARALLEL_GRAIN);
+
+	// partial results get their own cache lines so the threads don't fight over them
+	struct __CyxParallelArrayCtx ctx = { .arr = arr, .head = head, .fold_fn = fn, .stride = (head->size + 63) & ~(size_t)63 };
+	ctx.res = malloc(nthreads * ctx.stride);
+	assert(ctx.res);
+	for (size_t t = 0; t < nthreads; ++t) { memcpy(ctx.res + t * ctx.stride, accumulator, head->size); }
+
+	__cyx_parallel_run(nthreads, head->len, __cyx_array_fold_task, &ctx);
+
+	void* ret = __cyx_temp_alloc_deleted(head->size, accumulator, head->is_ptr, head->defer_fn);
+	for (size_t t = 0; t < nthreads; ++t) { combine_fn(ret, ctx.res + t * ctx.stride); }
+
+	free(ctx.res);
+	return ret;
+}
+
+#undef __cyx_array_sort_ctx
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * SegArray
+ */
+
+#if __CYX_CLOSE_FOLD
+
+#define __CYX_SEGARRAY_MAX_CHUNKS 64
+
+// chunk `k` holds `1 << (shift + k)` elements, so elements never move and the directory never grows
+typedef struct {
+	size_t size;
+	size_t len;
+	size_t cap;
+	size_t shift;
+	uint64_t mmap_chunks;
+
+	void (*defer_fn)(void*);
+	int (*cmp_fn)(const void*, const void*);
+	void (*print_fn)(const void*);
+
+	char is_ptr;
+	char huge_pages;
+} __CyxSegArrayHeader;
+
+#ifndef CYX_SEGARRAY_BASE_SIZE
+#define CYX_SEGARRAY_BASE_SIZE 16
+#endif // CYX_SEGARRAY_BASE_SIZE
+
+#define __CYX_SEGARRAY_HEADER_SIZE (sizeof(__CyxSegArrayHeader))
+#define __CYX_SEGARRAY_GET_HEADER(seg) ((__CyxSegArrayHeader*)(seg) - 1)
+
+void** __cyx_segarray_new(struct __CyxArrayParams params);
+void __cyx_segarray_append(void** seg, void* val);
+void* __cyx_segarray_pop(void** seg);
+int __cyx_segarray_find(void** seg, void* val);
+void __cyx_segarray_free(void** seg);
+void __cyx_segarray_print(void** seg);
+
+static inline void* __cyx_segarray_at(void** seg, size_t pos) {
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	if (pos >= head->len) { return NULL; }
+	size_t chunk = 63 - __builtin_clzll((pos >> head->shift) + 1);
+	size_t offset = pos - ((((size_t)1 << chunk) - 1) << head->shift);
+	return (char*)seg[chunk] + offset * head->size;
+}
+
+#define cyx_segarray_length(seg) (__CYX_SEGARRAY_GET_HEADER(seg)->len)
+#define cyx_segarray_foreach(val, seg) for ( \
+	struct { typeof(**(seg))* value; size_t idx; size_t chunk; size_t left; } val = { .value = (seg)[0], .left = (size_t)1 << __CYX_SEGARRAY_GET_HEADER(seg)->shift }; \
+	val.idx < cyx_segarray_length(seg); \
+	++val.idx, --val.left ? (void)++val.value : (void)(val.value = (seg)[++val.chunk], val.left = (size_t)1 << (__CYX_SEGARRAY_GET_HEADER(seg)->shift + val.chunk)))
+
+#define __cyx_segarray_new_params(...) __cyx_segarray_new((struct __CyxArrayParams){ 0, __VA_ARGS__ })
+#define cyx_segarray_new(T, ...) (T**)__cyx_segarray_new_params(.__size = sizeof(T), __VA_ARGS__)
+// the handle itself never changes, pointers returned by `at` stay valid until the element is popped
+#define cyx_segarray_append(seg, val) do { \
+	typeof(**(seg)) v = (val); \
+	__cyx_segarray_append((void**)(seg), &v); \
+} while(0)
+#define cyx_segarray_at(seg, pos) (typeof(**(seg))*)__cyx_segarray_at((void**)(seg), pos)
+#define cyx_segarray_pop(seg) (typeof(**(seg))*)__cyx_segarray_pop((void**)(seg))
+#define cyx_segarray_find(seg, val) __cyx_segarray_find((void**)(seg), val)
+#define cyx_segarray_free(seg) __cyx_segarray_free((void**)(seg))
+#define cyx_segarray_print(seg) __cyx_segarray_print((void**)(seg))
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define segarray_length(seg) cyx_segarray_length(seg)
+#define segarray_foreach(val, seg) cyx_segarray_foreach(val, seg)
+
+#define segarray_new(T, ...) cyx_segarray_new(T, __VA_ARGS__)
+#define segarray_append(seg, val) cyx_segarray_append(seg, val)
+#define segarray_at(seg, pos) cyx_segarray_at(seg, pos)
+#define segarray_pop(seg) cyx_segarray_pop(seg)
+#define segarray_find(seg, val) cyx_segarray_find(seg, val)
+#define segarray_free(seg) cyx_segarray_free(seg)
+#define segarray_print(seg) cyx_segarray_print(seg)
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+void** __cyx_segarray_new(struct __CyxArrayParams params) {
+	size_t shift = 0;
+	while (((size_t)1 << shift) < (params.reserve ? params.reserve : CYX_SEGARRAY_BASE_SIZE)) { ++shift; }
+
+	__CyxSegArrayHeader* head = calloc(1, __CYX_SEGARRAY_HEADER_SIZE + __CYX_SEGARRAY_MAX_CHUNKS * sizeof(void*));
+	if (!head) { return NULL; }
+	head->size = params.__size;
+	head->shift = shift;
+	head->is_ptr = params.is_ptr;
+	head->huge_pages = params.huge_pages;
+	head->defer_fn = params.defer_fn;
+	head->cmp_fn = params.cmp_fn;
+	head->print_fn = params.print_fn;
+	return (void**)(head + 1);
+}
+void __cyx_segarray_append(void** seg, void* val) {
+	assert(seg);
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	if (head->len == head->cap) {
+		size_t chunk = 63 - __builtin_clzll((head->len >> head->shift) + 1);
+		assert(chunk < __CYX_SEGARRAY_MAX_CHUNKS);
+		size_t chunk_len = (size_t)1 << (head->shift + chunk);
+		char is_mmap;
+		seg[chunk] = __cyx_mem_alloc(chunk_len * head->size, head->huge_pages, &is_mmap);
+		assert(seg[chunk] && "ERROR: Could not allocate a new chunk!");
+		head->mmap_chunks |= (uint64_t)is_mmap << chunk;
+		head->cap += chunk_len;
+	}
+	++head->len;
+	memcpy(__cyx_segarray_at(seg, head->len - 1), val, head->size);
+}
+void* __cyx_segarray_pop(void** seg) {
+	assert(seg);
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	if (!head->len) { return NULL; }
+
+	void* val = __cyx_segarray_at(seg, head->len - 1);
+	--head->len;
+	if (head->defer_fn) { return __cyx_temp_alloc_deleted(head->size, val, head->is_ptr, head->defer_fn); }
+	return val;
+}
+int __cyx_segarray_find(void** seg, void* val) {
+	assert(seg);
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	assert(head->cmp_fn && "ERROR: Trying to search without a compare function provided!");
+	size_t chunk = 0, left = (size_t)1 << head->shift;
+	char* curr = seg[0];
+	for (size_t i = 0; i < head->len; ++i) {
+		if (!__CYX_PTR_CMP(head, val, curr)) { return (int)i; }
+		if (--left) { curr += head->size; } else { curr = seg[++chunk]; left = (size_t)1 << (head->shift + chunk); }
+	}
+	return -1;
+}
+void __cyx_segarray_free(void** seg) {
+	assert(seg);
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	if (head->defer_fn) {
+		for (size_t i = 0; i < head->len; ++i) {
+			void* val = __cyx_segarray_at(seg, i);
+			head->defer_fn(!head->is_ptr ? val : *(void**)val);
+		}
+	}
+	for (size_t chunk = 0; chunk < __CYX_SEGARRAY_MAX_CHUNKS && seg[chunk]; ++chunk) {
+		__cyx_mem_free(seg[chunk], ((size_t)1 << (head->shift + chunk)) * head->size, (head->mmap_chunks >> chunk) & 1);
+	}
+	free(head);
+}
+void __cyx_segarray_print(void** seg) {
+	assert(seg);
+	__CyxSegArrayHeader* head = __CYX_SEGARRAY_GET_HEADER(seg);
+	assert(head->print_fn);
+	printf("{ ");
+	for (size_t i = 0; i < head->len; ++i) {
+		if (i) { printf(", "); }
+		void* val = __cyx_segarray_at(seg, i);
+		head->print_fn(!head->is_ptr ? val : *(void**)val);
+	}
+	printf(" }");
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Typed Array
+ */
+
+#if __CYX_CLOSE_FOLD
+
+// emits `name_new`, `name_append`, `name_at`, `name_sort`, `name_find` and `name_bsearch` for arrays of `T`,
+// `name_at` counts negative positions from the end and returns NULL out of range like `cyx_array_at`,
+// `cmp` is called directly so it can be inlined, the arrays keep the usual header and work with every `cyx_array_*` function
+#define CYX_DEFINE_ARRAY(name, T, cmp) \
+static inline T* name##_new(void) { \
+	return (T*)__cyx_array_new((struct __CyxArrayParams){ .__size = sizeof(T), .cmp_fn = (int (*)(const void*, const void*))(cmp) }); \
+} \
+static inline void name##_append(T** arr, T val) { \
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(*arr); \
+	if (head->len == head->cap) { \
+		__cyx_array_expand((void**)arr, 1); \
+		head = __CYX_ARRAY_GET_HEADER(*arr); \
+	} \
+	(*arr)[head->len++] = val; \
+} \
+static inline T* name##_at(T* arr, int64_t pos) { \
+	if (!arr) { return NULL; } \
+	int64_t len = __CYX_ARRAY_GET_HEADER(arr)->len; \
+	if (pos < 0) { pos += len; } \
+	if (pos < 0 || pos >= len) { return NULL; } \
+	return arr + pos; \
+} \
+static inline void name##_swap(T* l, T* r) { \
+	T tmp = *l; \
+	*l = *r; \
+	*r = tmp; \
+} \
+static inline void name##_insertion(T* base, size_t n) { \
+	for (size_t i = 1; i < n; ++i) { \
+		T val = base[i]; \
+		size_t j = i; \
+		for (; j && cmp(&val, &base[j - 1]) < 0; --j) { base[j] = base[j - 1]; } \
+		base[j] = val; \
+	} \
+} \
+static inline void name##_sift_down(T* base, size_t root, size_t n) { \
+	for (size_t child; (child = 2 * root + 1) < n; root = child) { \
+		if (child + 1 < n && cmp(&base[child], &base[child + 1]) < 0) { ++child; } \
+		if (cmp(&base[root], &base[child]) >= 0) { return; } \
+		name##_swap(&base[root], &base[child]); \
+	} \
+} \
+static inline void name##_introsort(T* base, size_t n, size_t depth) { \
+	while (n > __CYX_SORT_INSERTION_LIMIT) { \
+		if (!depth--) { \
+			for (size_t i = n / 2; i--;) { name##_sift_down(base, i, n); } \
+			for (size_t i = n; --i;) { \
+				name##_swap(&base[0], &base[i]); \
+				name##_sift_down(base, 0, i); \
+			} \
+			return; \
+		} \
+		/* median of three ends up in base[0], the largest of the three stops the left scan */ \
+		size_t mid = n / 2; \
+		if (cmp(&base[mid], &base[0]) < 0) { name##_swap(&base[mid], &base[0]); } \
+		if (cmp(&base[n - 1], &base[mid]) < 0) { \
+			name##_swap(&base[n - 1], &base[mid]); \
+			if (cmp(&base[mid], &base[0]) < 0) { name##_swap(&base[mid], &base[0]); } \
+		} \
+		name##_swap(&base[0], &base[mid]); \
+		size_t i = 0, j = n; \
+		for (;;) { \
+			while (cmp(&base[++i], &base[0]) < 0); \
+			while (cmp(&base[0], &base[--j]) < 0); \
+			if (i >= j) { break; } \
+			name##_swap(&base[i], &base[j]); \
+		} \
+		name##_swap(&base[0], &base[j]); \
+		if (j < n - j - 1) { \
+			name##_introsort(base, j, depth); \
+			base += j + 1; \
+			n -= j + 1; \
+		} else { \
+			name##_introsort(base + j + 1, n - j - 1, depth); \
+			n = j; \
+		} \
+	} \
+	name##_insertion(base, n); \
+} \
+static inline void name##_sort(T* arr) { \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->size == sizeof(T)); \
+	size_t n = __CYX_ARRAY_GET_HEADER(arr)->len, depth = 0; \
+	for (size_t m = n; m > 1; m >>= 1) { depth += 2; } \
+	name##_introsort(arr, n, depth); \
+} \
+static inline int name##_find(T* arr, T val) { \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->size == sizeof(T)); \
+	size_t n = __CYX_ARRAY_GET_HEADER(arr)->len; \
+	for (size_t i = 0; i < n; ++i) { \
+		if (!cmp(&arr[i], &val)) { return (int)i; } \
+	} \
+	return -1; \
+} \
+static inline int name##_bsearch(T* arr, T val) { \
+	assert(__CYX_ARRAY_GET_HEADER(arr)->size == sizeof(T)); \
+	size_t lo = 0, n = __CYX_ARRAY_GET_HEADER(arr)->len, len = n; \
+	while (n) { \
+		size_t half = n / 2; \
+		if (cmp(&arr[lo + half], &val) < 0) { \
+			lo += half + 1; \
+			n -= half + 1; \
+		} else { \
+			n = half; \
+		} \
+	} \
+	return lo < len && !cmp(&arr[lo], &val) ? (int)lo : -1; \
+}
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define DEFINE_ARRAY(name, T, cmp) CYX_DEFINE_ARRAY(name, T, cmp)
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Struct of Arrays
+ */
+
+#if __CYX_CLOSE_FOLD
+
+#define __CYX_NARGS(...) __CYX_NARGS_BASE(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define __CYX_NARGS_BASE(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n, ...) n
+#define __CYX_FOR_EACH(m, ...) __CYX_CONCAT_VALS__(__CYX_FOR_EACH_, __CYX_NARGS(__VA_ARGS__))(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_1(m, x) m(x)
+#define __CYX_FOR_EACH_2(m, x, ...) m(x) __CYX_FOR_EACH_1(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_3(m, x, ...) m(x) __CYX_FOR_EACH_2(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_4(m, x, ...) m(x) __CYX_FOR_EACH_3(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_5(m, x, ...) m(x) __CYX_FOR_EACH_4(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_6(m, x, ...) m(x) __CYX_FOR_EACH_5(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_7(m, x, ...) m(x) __CYX_FOR_EACH_6(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_8(m, x, ...) m(x) __CYX_FOR_EACH_7(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_9(m, x, ...) m(x) __CYX_FOR_EACH_8(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_10(m, x, ...) m(x) __CYX_FOR_EACH_9(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_11(m, x, ...) m(x) __CYX_FOR_EACH_10(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_12(m, x, ...) m(x) __CYX_FOR_EACH_11(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_13(m, x, ...) m(x) __CYX_FOR_EACH_12(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_14(m, x, ...) m(x) __CYX_FOR_EACH_13(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_15(m, x, ...) m(x) __CYX_FOR_EACH_14(m, __VA_ARGS__)
+#define __CYX_FOR_EACH_16(m, x, ...) m(x) __CYX_FOR_EACH_15(m, __VA_ARGS__)
+
+#define __CYX_SOA_TYPE_BASE(T, field) T
+#define __CYX_SOA_FIELD_BASE(T, field) field
+#define __CYX_SOA_TYPE(pair) __CYX_SOA_TYPE_BASE pair
+#define __CYX_SOA_FIELD(pair) __CYX_SOA_FIELD_BASE pair
+
+#define __CYX_SOA_ROW_MEMBER(pair) __CYX_SOA_TYPE(pair) __CYX_SOA_FIELD(pair);
+#define __CYX_SOA_COLUMN_MEMBER(pair) __CYX_SOA_TYPE(pair)* __CYX_SOA_FIELD(pair);
+#define __CYX_SOA_NEW(pair) soa.__CYX_SOA_FIELD(pair) = __cyx_array_new((struct __CyxArrayParams){ .__size = sizeof(__CYX_SOA_TYPE(pair)), .reserve = soa.cap }); \
+	assert(soa.__CYX_SOA_FIELD(pair));
+#define __CYX_SOA_APPEND(pair) soa->__CYX_SOA_FIELD(pair)[soa->len] = row.__CYX_SOA_FIELD(pair); \
+	__CYX_ARRAY_GET_HEADER(soa->__CYX_SOA_FIELD(pair))->len = soa->len + 1;
+#define __CYX_SOA_GET(pair) row.__CYX_SOA_FIELD(pair) = soa->__CYX_SOA_FIELD(pair)[pos];
+#define __CYX_SOA_SET(pair) soa->__CYX_SOA_FIELD(pair)[pos] = row.__CYX_SOA_FIELD(pair);
+#define __CYX_SOA_RESERVE(pair) __cyx_array_reserve((void**)&soa->__CYX_SOA_FIELD(pair), n);
+#define __CYX_SOA_PERMUTE(pair) __cyx_soa_permute(soa->__CYX_SOA_FIELD(pair), perm);
+#define __CYX_SOA_FREE(pair) cyx_array_free(soa->__CYX_SOA_FIELD(pair));
+
+// every column is a regular array, so `soa.field` can be handed to `cyx_array_*` functions and the numeric kernels
+// as long as its length is not changed behind the container's back, all columns share `cap` and grow together
+#define CYX_DEFINE_SOA(name, ...) \
+typedef struct { __CYX_FOR_EACH(__CYX_SOA_ROW_MEMBER, __VA_ARGS__) } name##_row; \
+typedef struct { size_t len; size_t cap; __CYX_FOR_EACH(__CYX_SOA_COLUMN_MEMBER, __VA_ARGS__) } name; \
+static inline name name##_new(size_t reserve) { \
+	name soa = { .cap = reserve ? reserve : CYX_ARRAY_BASE_SIZE }; \
+	__CYX_FOR_EACH(__CYX_SOA_NEW, __VA_ARGS__) \
+	return soa; \
+} \
+static inline void name##_reserve(name* soa, size_t n) { \
+	if (n <= soa->cap) { return; } \
+	__CYX_FOR_EACH(__CYX_SOA_RESERVE, __VA_ARGS__) \
+	soa->cap = n; \
+} \
+static inline void name##_append(name* soa, name##_row row) { \
+	if (soa->len == soa->cap) { \
+		size_t cap = soa->cap * CYX_ARRAY_GROWTH; \
+		name##_reserve(soa, cap > soa->cap ? cap : soa->cap + 1); \
+	} \
+	__CYX_FOR_EACH(__CYX_SOA_APPEND, __VA_ARGS__) \
+	++soa->len; \
+} \
+static inline name##_row name##_at(const name* soa, size_t pos) { \
+	assert(pos < soa->len); \
+	name##_row row; \
+	__CYX_FOR_EACH(__CYX_SOA_GET, __VA_ARGS__) \
+	return row; \
+} \
+static inline void name##_set(name* soa, size_t pos, name##_row row) { \
+	assert(pos < soa->len); \
+	__CYX_FOR_EACH(__CYX_SOA_SET, __VA_ARGS__) \
+} \
+static inline void name##_permute(name* soa, const size_t* perm) { \
+	__CYX_FOR_EACH(__CYX_SOA_PERMUTE, __VA_ARGS__) \
+} \
+static inline void name##_free(name* soa) { \
+	__CYX_FOR_EACH(__CYX_SOA_FREE, __VA_ARGS__) \
+	soa->len = soa->cap = 0; \
+}
+
+size_t* __cyx_soa_sort_perm(const void* column, int (*cmp_fn)(const void*, const void*));
+void __cyx_soa_permute(void* column, const size_t* perm);
+
+// stable sort of every row by one column, `cmp` compares two elements of that column
+#define cyx_soa_sort_by(name, soa, field, cmp) do { \
+	size_t* perm = __cyx_soa_sort_perm((soa)->field, cmp); \
+	name##_permute(soa, perm); \
+	free(perm); \
+} while(0)
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define DEFINE_SOA(name, ...) CYX_DEFINE_SOA(name, __VA_ARGS__)
+#define soa_sort_by(name, soa, field, cmp) cyx_soa_sort_by(name, soa, field, cmp)
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+// sorts (key, index) pairs so only one column is touched while comparing, the key sits first so `cmp_fn` can read it
+size_t* __cyx_soa_sort_perm(const void* column, int (*cmp_fn)(const void*, const void*)) {
+	assert(column);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(column);
+	size_t key_size = (head->size + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+	size_t pair_size = key_size + sizeof(size_t);
+
+	char* pairs = malloc(head->len * pair_size);
+	size_t* perm = malloc((head->len ? head->len : 1) * sizeof(size_t));
+	assert(pairs && perm);
+	for (size_t i = 0; i < head->len; ++i) {
+		memcpy(pairs + i * pair_size, __CYX_DATA_GET_AT(head, column, i), head->size);
+		memcpy(pairs + i * pair_size + key_size, &i, sizeof(size_t));
+	}
+	__cyx_sort_stable_range(pairs, head->len, pair_size, cmp_fn, 0);
+	for (size_t i = 0; i < head->len; ++i) { memcpy(&perm[i], pairs + i * pair_size + key_size, sizeof(size_t)); }
+
+	free(pairs);
+	return perm;
+}
+void __cyx_soa_permute(void* column, const size_t* perm) {
+	assert(column);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(column);
+	char* tmp = malloc(head->len * head->size + 1);
+	assert(tmp);
+	for (size_t i = 0; i < head->len; ++i) { __cyx_copy(tmp + i * head->size, __CYX_DATA_GET_AT(head, column, perm[i]), head->size); }
+	memcpy(column, tmp, head->len * head->size);
+	free(tmp);
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Numeric Kernels
+ */
+
+#if __CYX_CLOSE_FOLD
+
+// typed kernels for arrays of plain numbers, integer sums and dot products are 64 bit wide, float ones are done in double
+int64_t cyx_array_sum_i32(const int32_t* arr);
+int64_t cyx_array_sum_i64(const int64_t* arr);
+double cyx_array_sum_f32(const float* arr);
+double cyx_array_sum_f64(const double* arr);
+// return 0 and leave `min`/`max` untouched for an empty array, NaNs are not handled
+int cyx_array_min_max_i32(const int32_t* arr, int32_t* min, int32_t* max);
+int cyx_array_min_max_i64(const int64_t* arr, int64_t* min, int64_t* max);
+int cyx_array_min_max_f32(const float* arr, float* min, float* max);
+int cyx_array_min_max_f64(const double* arr, double* min, double* max);
+size_t cyx_array_count_eq_i32(const int32_t* arr, int32_t val);
+size_t cyx_array_count_eq_i64(const int64_t* arr, int64_t val);
+size_t cyx_array_count_eq_f32(const float* arr, float val);
+size_t cyx_array_count_eq_f64(const double* arr, double val);
+int cyx_array_find_eq_i32(const int32_t* arr, int32_t val);
+int cyx_array_find_eq_i64(const int64_t* arr, int64_t val);
+int cyx_array_find_eq_f32(const float* arr, float val);
+int cyx_array_find_eq_f64(const double* arr, double val);
+// both arrays need to have the same length
+int64_t cyx_array_dot_i32(const int32_t* a, const int32_t* b);
+int64_t cyx_array_dot_i64(const int64_t* a, const int64_t* b);
+double cyx_array_dot_f32(const float* a, const float* b);
+double cyx_array_dot_f64(const double* a, const double* b);
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define array_sum_i32 cyx_array_sum_i32
+#define array_sum_i64 cyx_array_sum_i64
+#define array_sum_f32 cyx_array_sum_f32
+#define array_sum_f64 cyx_array_sum_f64
+#define array_min_max_i32 cyx_array_min_max_i32
+#define array_min_max_i64 cyx_array_min_max_i64
+#define array_min_max_f32 cyx_array_min_max_f32
+#define array_min_max_f64 cyx_array_min_max_f64
+#define array_count_eq_i32 cyx_array_count_eq_i32
+#define array_count_eq_i64 cyx_array_count_eq_i64
+#define array_count_eq_f32 cyx_array_count_eq_f32
+#define array_count_eq_f64 cyx_array_count_eq_f64
+#define array_find_eq_i32 cyx_array_find_eq_i32
+#define array_find_eq_i64 cyx_array_find_eq_i64
+#define array_find_eq_f32 cyx_array_find_eq_f32
+#define array_find_eq_f64 cyx_array_find_eq_f64
+#define array_dot_i32 cyx_array_dot_i32
+#define array_dot_i64 cyx_array_dot_i64
+#define array_dot_f32 cyx_array_dot_f32
+#define array_dot_f64 cyx_array_dot_f64
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+#if defined(__x86_64__) || defined(__i386__)
+#define __CYX_X86 1
+#define __CYX_TARGET_avx2 __attribute__((target("avx2,popcnt")))
+#define __CYX_TARGET_avx512 __attribute__((target("avx512f,popcnt")))
+#endif // __x86_64__ || __i386__
+#define __CYX_TARGET_base
+
+#ifdef __CYX_X86
+static int __cyx_has_avx2(void) {
+	static int has = -1;
+	int res = __atomic_load_n(&has, __ATOMIC_RELAXED);
+	if (res < 0) {
+		__builtin_cpu_init();
+		res = __builtin_cpu_supports("avx2") != 0;
+		__atomic_store_n(&has, res, __ATOMIC_RELAXED);
+	}
+	return res;
+}
+static int __cyx_has_avx512(void) {
+	static int has = -1;
+	int res = __atomic_load_n(&has, __ATOMIC_RELAXED);
+	if (res < 0) {
+		__builtin_cpu_init();
+		res = __builtin_cpu_supports("avx512f") != 0;
+		__atomic_store_n(&has, res, __ATOMIC_RELAXED);
+	}
+	return res;
+}
+#endif // __CYX_X86
+
+// one instantiation per instruction set, written with vector extensions so the compiler picks the instructions
+// T - element, A - accumulator, M - comparison mask lane, W - vector width in bytes
+#define __CYX_DEFINE_KERNELS(suffix, isa, T, A, M, W) \
+typedef T __cyx_vec_##suffix##_##isa __attribute__((vector_size(W))); \
+typedef A __cyx_acc_##suffix##_##isa __attribute__((vector_size(W / sizeof(T) * sizeof(A)))); \
+typedef M __cyx_mask_##suffix##_##isa __attribute__((vector_size(W))); \
+__CYX_TARGET_##isa static A __cyx_sum_##suffix##_##isa(const T* p, size_t n) { \
+	enum { L = W / sizeof(T) }; \
+	__cyx_acc_##suffix##_##isa acc0 = { 0 }, acc1 = { 0 }; \
+	size_t i = 0; \
+	for (; i + 2 * L <= n; i += 2 * L) { \
+		__cyx_vec_##suffix##_##isa v0, v1; \
+		memcpy(&v0, p + i, W); \
+		memcpy(&v1, p + i + L, W); \
+		acc0 += __builtin_convertvector(v0, __cyx_acc_##suffix##_##isa); \
+		acc1 += __builtin_convertvector(v1, __cyx_acc_##suffix##_##isa); \
+	} \
+	acc0 += acc1; \
+	A res = 0; \
+	for (size_t l = 0; l < L; ++l) { res += acc0[l]; } \
+	for (; i < n; ++i) { res += p[i]; } \
+	return res; \
+} \
+__CYX_TARGET_##isa static void __cyx_min_max_##suffix##_##isa(const T* p, size_t n, T* min, T* max) { \
+	enum { L = W / sizeof(T) }; \
+	T lo = p[0], hi = p[0]; \
+	size_t i = 0; \
+	if (n >= L) { \
+		__cyx_vec_##suffix##_##isa vlo, vhi; \
+		memcpy(&vlo, p, W); \
+		vhi = vlo; \
+		for (i = L; i + L <= n; i += L) { \
+			__cyx_vec_##suffix##_##isa v; \
+			memcpy(&v, p + i, W); \
+			__cyx_mask_##suffix##_##isa lt = v < vlo, gt = v > vhi; \
+			vlo = (__cyx_vec_##suffix##_##isa)(((__cyx_mask_##suffix##_##isa)v & lt) | ((__cyx_mask_##suffix##_##isa)vlo & ~lt)); \
+			vhi = (__cyx_vec_##suffix##_##isa)(((__cyx_mask_##suffix##_##isa)v & gt) | ((__cyx_mask_##suffix##_##isa)vhi & ~gt)); \
+		} \
+		lo = vlo[0]; \
+		hi = vhi[0]; \
+		for (size_t l = 1; l < L; ++l) { \
+			if (vlo[l] < lo) { lo = vlo[l]; } \
+			if (vhi[l] > hi) { hi = vhi[l]; } \
+		} \
+	} \
+	for (; i < n; ++i) { \
+		if (p[i] < lo) { lo = p[i]; } \
+		if (p[i] > hi) { hi = p[i]; } \
+	} \
+	*min = lo; \
+	*max = hi; \
+} \
+__CYX_TARGET_##isa static size_t __cyx_count_eq_##suffix##_##isa(const T* p, size_t n, T val) { \
+	enum { L = W / sizeof(T) }; \
+	size_t res = 0, i = 0; \
+	while (i + L <= n) { \
+		/* lane counters are flushed before they can overflow */ \
+		size_t blocks = (n - i) / L; \
+		if (blocks > (1u << 30)) { blocks = 1u << 30; } \
+		__cyx_mask_##suffix##_##isa cnt = { 0 }; \
+		for (size_t b = 0; b < blocks; ++b, i += L) { \
+			__cyx_vec_##suffix##_##isa v; \
+			memcpy(&v, p + i, W); \
+			cnt -= v == val; \
+		} \
+		for (size_t l = 0; l < L; ++l) { res += (size_t)cnt[l]; } \
+	} \
+	for (; i < n; ++i) { res += p[i] == val; } \
+	return res; \
+} \
+__CYX_TARGET_##isa static int __cyx_find_eq_##suffix##_##isa(const T* p, size_t n, T val) { \
+	enum { L = W / sizeof(T) }; \
+	size_t i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_vec_##suffix##_##isa v; \
+		memcpy(&v, p + i, W); \
+		__cyx_mask_##suffix##_##isa eq = v == val; \
+		uint64_t words[W / 8], any = 0; \
+		memcpy(words, &eq, W); \
+		for (size_t w = 0; w < W / 8; ++w) { any |= words[w]; } \
+		if (any) { break; } \
+	} \
+	for (; i < n; ++i) { \
+		if (p[i] == val) { return (int)i; } \
+	} \
+	return -1; \
+} \
+__CYX_TARGET_##isa static A __cyx_dot_##suffix##_##isa(const T* a, const T* b, size_t n) { \
+	enum { L = W / sizeof(T) }; \
+	__cyx_acc_##suffix##_##isa acc = { 0 }; \
+	size_t i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_vec_##suffix##_##isa va, vb; \
+		memcpy(&va, a + i, W); \
+		memcpy(&vb, b + i, W); \
+		acc += __builtin_convertvector(va, __cyx_acc_##suffix##_##isa) * __builtin_convertvector(vb, __cyx_acc_##suffix##_##isa); \
+	} \
+	A res = 0; \
+	for (size_t l = 0; l < L; ++l) { res += acc[l]; } \
+	for (; i < n; ++i) { res += (A)a[i] * (A)b[i]; } \
+	return res; \
+}
+
+#ifdef __CYX_X86
+#define __CYX_KERNEL_CALL(fn, suffix, ...) (__cyx_has_avx2() ? __cyx_##fn##_##suffix##_avx2(__VA_ARGS__) : __cyx_##fn##_##suffix##_base(__VA_ARGS__))
+#define __CYX_DEFINE_KERNELS_ALL(suffix, T, A, M) \
+	__CYX_DEFINE_KERNELS(suffix, base, T, A, M, 16) \
+	__CYX_DEFINE_KERNELS(suffix, avx2, T, A, M, 32)
+#else
+#define __CYX_KERNEL_CALL(fn, suffix, ...) __cyx_##fn##_##suffix##_base(__VA_ARGS__)
+#define __CYX_DEFINE_KERNELS_ALL(suffix, T, A, M) \
+	__CYX_DEFINE_KERNELS(suffix, base, T, A, M, 16)
+#endif // __CYX_X86
+
+#define __CYX_DEFINE_KERNEL_API(suffix, T, A, M) \
+__CYX_DEFINE_KERNELS_ALL(suffix, T, A, M) \
+A cyx_array_sum_##suffix(const T* arr) { \
+	assert(arr); \
+	return __CYX_KERNEL_CALL(sum, suffix, arr, __CYX_ARRAY_GET_HEADER(arr)->len); \
+} \
+int cyx_array_min_max_##suffix(const T* arr, T* min, T* max) { \
+	assert(arr); \
+	size_t n = __CYX_ARRAY_GET_HEADER(arr)->len; \
+	if (!n) { return 0; } \
+	__CYX_KERNEL_CALL(min_max, suffix, arr, n, min, max); \
+	return 1; \
+} \
+size_t cyx_array_count_eq_##suffix(const T* arr, T val) { \
+	assert(arr); \
+	return __CYX_KERNEL_CALL(count_eq, suffix, arr, __CYX_ARRAY_GET_HEADER(arr)->len, val); \
+} \
+int cyx_array_find_eq_##suffix(const T* arr, T val) { \
+	assert(arr); \
+	return __CYX_KERNEL_CALL(find_eq, suffix, arr, __CYX_ARRAY_GET_HEADER(arr)->len, val); \
+} \
+A cyx_array_dot_##suffix(const T* a, const T* b) { \
+	assert(a && b); \
+	assert(__CYX_ARRAY_GET_HEADER(a)->len == __CYX_ARRAY_GET_HEADER(b)->len && "ERROR: Dot product of arrays with different lengths!"); \
+	return __CYX_KERNEL_CALL(dot, suffix, a, b, __CYX_ARRAY_GET_HEADER(a)->len); \
+}
+
+__CYX_DEFINE_KERNEL_API(i32, int32_t, int64_t, int32_t)
+__CYX_DEFINE_KERNEL_API(i64, int64_t, int64_t, int64_t)
+__CYX_DEFINE_KERNEL_API(f32, float, double, int32_t)
+__CYX_DEFINE_KERNEL_API(f64, double, double, int64_t)
+
+#undef __CYX_DEFINE_KERNEL_API
+#undef __CYX_DEFINE_KERNELS_ALL
+#undef __CYX_KERNEL_CALL
+#undef __CYX_DEFINE_KERNELS
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Bitmap
+ */
+
+#if __CYX_CLOSE_FOLD
+
+// size in bits is stored at [-1] and capacity in bits at [-2], bits past the size are always zero
+// (hashset/hashmap embed bitmaps with only the size word, those never get resized or freed on their own)
+#define cyx_bitmap_size(bitmap) (*(bitmap - 1))
+#define cyx_bitmap_capacity(bitmap) (*(bitmap - 2))
+#define __CYX_BITMAP_WORD_BITS (8 * sizeof(size_t))
+#define __CYX_BITMAP_WORDS(size) (((size) + __CYX_BITMAP_WORD_BITS - 1) / __CYX_BITMAP_WORD_BITS)
+
+size_t* cyx_bitmap_new(size_t size);
+size_t* cyx_bitmap_copy(const size_t* const bitmap);
+int cyx_bitmap_get(const size_t* const bitmap, int64_t pos);
+void cyx_bitmap_flip(size_t* bitmap, int64_t pos);
+void cyx_bitmap_set(size_t* bitmap, int64_t pos, int val);
 void cyx_bitmap_free(void* bitmap);
 void cyx_bitmap_print(const void* bitmap);
+void __cyx_bitmap_reserve(size_t** bitmap_ptr, size_t size);
+void __cyx_bitmap_resize(size_t** bitmap_ptr, size_t size);
+
+// both can move the bitmap, new bits are zero
+#define cyx_bitmap_reserve(bitmap, size) __cyx_bitmap_reserve(&(bitmap), size)
+#define cyx_bitmap_resize(bitmap, size) __cyx_bitmap_resize(&(bitmap), size)
+
+// operands can differ in size: missing bits count as zero, new bitmaps take the larger size
+// and the `_self` variants keep the size of `self`
 size_t* cyx_bitmap_and(const size_t* const bitmap1, const size_t* const bitmap2);
 size_t* cyx_bitmap_and_self(size_t* self, const size_t* const other);
 size_t* cyx_bitmap_or(const size_t* const bitmap1, const size_t* const bitmap2);
 size_t* cyx_bitmap_or_self(size_t* self, const size_t* const other);
 size_t* cyx_bitmap_xor(const size_t* const bitmap1, const size_t* const bitmap2);
 size_t* cyx_bitmap_xor_self(size_t* self, const size_t* const other);
+size_t* cyx_bitmap_andnot(const size_t* const bitmap1, const size_t* const bitmap2);
+size_t* cyx_bitmap_andnot_self(size_t* self, const size_t* const other);
+size_t* cyx_bitmap_not(const size_t* const bitmap);
+size_t* cyx_bitmap_not_self(size_t* self);
+// popcount of the result without materializing it
+size_t cyx_bitmap_and_count(const size_t* const bitmap1, const size_t* const bitmap2);
+size_t cyx_bitmap_or_count(const size_t* const bitmap1, const size_t* const bitmap2);
+size_t cyx_bitmap_xor_count(const size_t* const bitmap1, const size_t* const bitmap2);
+size_t cyx_bitmap_andnot_count(const size_t* const bitmap1, const size_t* const bitmap2);
+// intersection of `n` bitmaps
+size_t* cyx_bitmap_and_many(const size_t* const* bitmaps, size_t n);
+
+// ranges are [from, to), partial words at both ends are masked and the words between them are written whole
+void cyx_bitmap_set_range(size_t* bitmap, size_t from, size_t to);
+void cyx_bitmap_clear_range(size_t* bitmap, size_t from, size_t to);
+void cyx_bitmap_flip_range(size_t* bitmap, size_t from, size_t to);
+int cyx_bitmap_all_in_range(const size_t* const bitmap, size_t from, size_t to);
+int cyx_bitmap_any_in_range(const size_t* const bitmap, size_t from, size_t to);
+
+// safe to call concurrently with each other on a shared bitmap, mixing them with the plain writers above isn't
+int cyx_bitmap_atomic_get(const size_t* const bitmap, size_t pos);
+// return the previous value of the bit
+int cyx_bitmap_test_and_set(size_t* bitmap, size_t pos);
+int cyx_bitmap_test_and_clear(size_t* bitmap, size_t pos);
+// ors `mask` into the word at index `word`, returns the previous word
+size_t cyx_bitmap_fetch_or(size_t* bitmap, size_t word, size_t mask);
+// sets and returns the first zero bit at or after `hint` (wrapping around), or `cyx_bitmap_size` when there's none
+size_t cyx_bitmap_claim_first_zero(size_t* bitmap, size_t hint);
+
+// queries below work a word at a time, positions that don't exist are reported as `cyx_bitmap_size`
+size_t cyx_bitmap_count(const size_t* const bitmap);
+size_t cyx_bitmap_find_first_set(const size_t* const bitmap);
+size_t cyx_bitmap_find_first_zero(const size_t* const bitmap);
+size_t cyx_bitmap_next_set(const size_t* const bitmap, size_t from);
+// number of set bits before `pos`
+size_t cyx_bitmap_rank(const size_t* const bitmap, size_t pos);
+// position of the set bit with rank `k`
+size_t cyx_bitmap_select(const size_t* const bitmap, size_t k);
+
+#define cyx_bitmap_foreach_set(pos, bitmap) for (size_t pos = cyx_bitmap_next_set(bitmap, 0); pos < cyx_bitmap_size(bitmap); pos = cyx_bitmap_next_set(bitmap, pos + 1))
 
 #ifdef CYLIBX_STRIP_PREFIX
 
 #define bitmap_size(bitmap) cyx_bitmap_size(bitmap)
+#define bitmap_capacity(bitmap) cyx_bitmap_capacity(bitmap)
+#define bitmap_reserve(bitmap, size) cyx_bitmap_reserve(bitmap, size)
+#define bitmap_resize(bitmap, size) cyx_bitmap_resize(bitmap, size)
+#define bitmap_foreach_set(pos, bitmap) cyx_bitmap_foreach_set(pos, bitmap)
 
 #define bitmap_new cyx_bitmap_new
 #define bitmap_copy cyx_bitmap_copy
@@ -628,62 +2799,106 @@ size_t* cyx_bitmap_xor_self(size_t* self, const size_t* const other);
 #define bitmap_or_self cyx_bitmap_or_self
 #define bitmap_xor cyx_bitmap_xor
 #define bitmap_xor_self cyx_bitmap_xor_self
+#define bitmap_andnot cyx_bitmap_andnot
+#define bitmap_andnot_self cyx_bitmap_andnot_self
+#define bitmap_not cyx_bitmap_not
+#define bitmap_not_self cyx_bitmap_not_self
+#define bitmap_and_count cyx_bitmap_and_count
+#define bitmap_or_count cyx_bitmap_or_count
+#define bitmap_xor_count cyx_bitmap_xor_count
+#define bitmap_andnot_count cyx_bitmap_andnot_count
+#define bitmap_and_many cyx_bitmap_and_many
+
+#define bitmap_set_range cyx_bitmap_set_range
+#define bitmap_clear_range cyx_bitmap_clear_range
+#define bitmap_flip_range cyx_bitmap_flip_range
+#define bitmap_all_in_range cyx_bitmap_all_in_range
+#define bitmap_any_in_range cyx_bitmap_any_in_range
+
+#define bitmap_atomic_get cyx_bitmap_atomic_get
+#define bitmap_test_and_set cyx_bitmap_test_and_set
+#define bitmap_test_and_clear cyx_bitmap_test_and_clear
+#define bitmap_fetch_or cyx_bitmap_fetch_or
+#define bitmap_claim_first_zero cyx_bitmap_claim_first_zero
+
+#define bitmap_count cyx_bitmap_count
+#define bitmap_find_first_set cyx_bitmap_find_first_set
+#define bitmap_find_first_zero cyx_bitmap_find_first_zero
+#define bitmap_next_set cyx_bitmap_next_set
+#define bitmap_rank cyx_bitmap_rank
+#define bitmap_select cyx_bitmap_select
 
 #endif // CYLIBX_STRIP_PREFIX
 
 #ifdef CYLIBX_IMPLEMENTATION
 
 size_t* cyx_bitmap_new(size_t size) {
-	size_t* ret = calloc(2 + (size - 1) / (8 * sizeof(size_t)), sizeof(size_t));
+	size_t words = __CYX_BITMAP_WORDS(size);
+	size_t* ret = calloc(2 + words, sizeof(size_t));
 	if (!ret) { return NULL; }
-	*ret = size;
-	return ret + 1;
+	ret[0] = words * __CYX_BITMAP_WORD_BITS;
+	ret[1] = size;
+	return ret + 2;
 }
 size_t* cyx_bitmap_copy(const size_t* const bitmap) {
-	size_t* ret = malloc(((cyx_bitmap_size(bitmap) - 1) / (8 * sizeof(size_t)) + 2) * sizeof(size_t));
+	size_t words = __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap));
+	size_t* ret = malloc((2 + words) * sizeof(size_t));
 	if (!ret) { return NULL; }
-	*ret = cyx_bitmap_size(bitmap);
-	memcpy(ret + 1, bitmap, (((*ret - 1) / (8 * sizeof(size_t)) + 1) * sizeof(size_t)));
-	return ret + 1;
+	ret[0] = words * __CYX_BITMAP_WORD_BITS;
+	ret[1] = cyx_bitmap_size(bitmap);
+	memcpy(ret + 2, bitmap, words * sizeof(size_t));
+	return ret + 2;
 }
-int cyx_bitmap_get(const size_t* const bitmap, int pos) {
+int cyx_bitmap_get(const size_t* const bitmap, int64_t pos) {
 	assert(bitmap);
 	if (pos < 0) { pos += cyx_bitmap_size(bitmap); }
-	assert(pos < (int)cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	assert(pos >= 0 && (size_t)pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
 
-	int bitmap_pos = pos / (8 * sizeof(size_t));
-	int inbyte_pos = pos - bitmap_pos * 8 * sizeof(size_t);
-	return bitmap[bitmap_pos] & (0b1ull << inbyte_pos) ? 1 : 0;
+	return (bitmap[pos / __CYX_BITMAP_WORD_BITS] >> (pos % __CYX_BITMAP_WORD_BITS)) & 1;
 }
-void cyx_bitmap_flip(size_t* bitmap, int pos) {
+void cyx_bitmap_flip(size_t* bitmap, int64_t pos) {
 	assert(bitmap);
 	if (pos < 0) { pos += cyx_bitmap_size(bitmap); }
-	assert(pos < (int)cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	assert(pos >= 0 && (size_t)pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
 
-	int bitmap_pos = pos / (8 * sizeof(size_t));
-	int inbyte_pos = pos - bitmap_pos * 8 * sizeof(size_t);
-	if (bitmap[bitmap_pos] & (0b1 << inbyte_pos) ? 1 : 0) {
-		bitmap[bitmap_pos] |= 0b1 << inbyte_pos;
-	} else {
-		bitmap[bitmap_pos] &= ~(0b1 << inbyte_pos);
-	}
+	bitmap[pos / __CYX_BITMAP_WORD_BITS] ^= (size_t)1 << (pos % __CYX_BITMAP_WORD_BITS);
 }
-void cyx_bitmap_set(size_t* bitmap, int pos, int val) {
+void cyx_bitmap_set(size_t* bitmap, int64_t pos, int val) {
 	assert(bitmap);
 	if (pos < 0) { pos += cyx_bitmap_size(bitmap); }
-	assert(pos < (int)cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	assert(pos >= 0 && (size_t)pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
 
-	int bitmap_pos = pos / (8 * sizeof(size_t));
-	int inbyte_pos = pos - bitmap_pos * 8 * sizeof(size_t);
 	if (val) {
-		bitmap[bitmap_pos] |= 0b1ull << inbyte_pos;
+		bitmap[pos / __CYX_BITMAP_WORD_BITS] |= (size_t)1 << (pos % __CYX_BITMAP_WORD_BITS);
 	} else {
-		bitmap[bitmap_pos] &= ~(0b1ull << inbyte_pos);
+		bitmap[pos / __CYX_BITMAP_WORD_BITS] &= ~((size_t)1 << (pos % __CYX_BITMAP_WORD_BITS));
 	}
 }
 void cyx_bitmap_free(void* bitmap) {
 	assert(bitmap);
-	free((size_t*)bitmap - 1);
+	free((size_t*)bitmap - 2);
+}
+void __cyx_bitmap_reserve(size_t** bitmap_ptr, size_t size) {
+	assert(*bitmap_ptr);
+	size_t old_words = cyx_bitmap_capacity(*bitmap_ptr) / __CYX_BITMAP_WORD_BITS, words = __CYX_BITMAP_WORDS(size);
+	if (words <= old_words) { return; }
+
+	size_t* ret = realloc(*bitmap_ptr - 2, (2 + words) * sizeof(size_t));
+	assert(ret && "ERROR: Could not resize the bitmap!");
+	memset(ret + 2 + old_words, 0, (words - old_words) * sizeof(size_t));
+	ret[0] = words * __CYX_BITMAP_WORD_BITS;
+	*bitmap_ptr = ret + 2;
+}
+void __cyx_bitmap_resize(size_t** bitmap_ptr, size_t size) {
+	assert(*bitmap_ptr);
+	size_t old_size = cyx_bitmap_size(*bitmap_ptr);
+	if (size < old_size) {
+		cyx_bitmap_clear_range(*bitmap_ptr, size, old_size);
+	} else if (size > cyx_bitmap_capacity(*bitmap_ptr)) {
+		size_t cap = 2 * cyx_bitmap_capacity(*bitmap_ptr);
+		__cyx_bitmap_reserve(bitmap_ptr, size > cap ? size : cap);
+	}
+	cyx_bitmap_size(*bitmap_ptr) = size;
 }
 void cyx_bitmap_print(const void* bitmap) {
 	printf("0b");
@@ -692,45 +2907,1016 @@ void cyx_bitmap_print(const void* bitmap) {
 	}
 }
 
-size_t* cyx_bitmap_and(const size_t* const bitmap1, const size_t* const bitmap2) {
-	if (!bitmap1 || !bitmap2 || cyx_bitmap_size(bitmap1) != cyx_bitmap_size(bitmap2)) { return NULL; }
-	size_t* res = cyx_bitmap_copy(bitmap1);
-	size_t size = (cyx_bitmap_size(res) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { res[i] &= bitmap2[i]; }
+// same scheme as the numeric kernels, words past the last bit are kept zero so every op can run on whole words
+#define __CYX_DEFINE_BITMAP_OP(name, isa, W, expr) \
+__CYX_TARGET_##isa static void __cyx_bitmap_##name##_##isa(size_t* dst, const size_t* x, const size_t* y, size_t n) { \
+	enum { L = W / sizeof(size_t) }; \
+	size_t i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_bitvec_##isa a, b; \
+		memcpy(&a, x + i, W); \
+		memcpy(&b, y + i, W); \
+		a = expr; \
+		memcpy(dst + i, &a, W); \
+	} \
+	for (; i < n; ++i) { \
+		size_t a = x[i], b = y[i]; \
+		dst[i] = expr; \
+	} \
+} \
+__CYX_TARGET_##isa static size_t __cyx_bitmap_##name##_count_##isa(const size_t* x, const size_t* y, size_t n) { \
+	enum { L = W / sizeof(size_t) }; \
+	size_t res = 0, i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_bitvec_##isa a, b; \
+		memcpy(&a, x + i, W); \
+		memcpy(&b, y + i, W); \
+		a = expr; \
+		for (size_t l = 0; l < L; ++l) { res += __builtin_popcountll(a[l]); } \
+	} \
+	for (; i < n; ++i) { \
+		size_t a = x[i], b = y[i]; \
+		res += __builtin_popcountll(expr); \
+	} \
+	return res; \
+}
+
+#define __CYX_DEFINE_BITMAP_KERNELS(isa, W) \
+typedef size_t __cyx_bitvec_##isa __attribute__((vector_size(W))); \
+__CYX_DEFINE_BITMAP_OP(and, isa, W, a & b) \
+__CYX_DEFINE_BITMAP_OP(or, isa, W, a | b) \
+__CYX_DEFINE_BITMAP_OP(xor, isa, W, a ^ b) \
+__CYX_DEFINE_BITMAP_OP(andnot, isa, W, a & ~b) \
+__CYX_TARGET_##isa static void __cyx_bitmap_not_##isa(size_t* dst, const size_t* x, size_t n) { \
+	enum { L = W / sizeof(size_t) }; \
+	size_t i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_bitvec_##isa a; \
+		memcpy(&a, x + i, W); \
+		a = ~a; \
+		memcpy(dst + i, &a, W); \
+	} \
+	for (; i < n; ++i) { dst[i] = ~x[i]; } \
+} \
+__CYX_TARGET_##isa static size_t __cyx_bitmap_popcount_##isa(const size_t* x, size_t n) { \
+	enum { L = W / sizeof(size_t) }; \
+	size_t res = 0, i = 0; \
+	for (; i + L <= n; i += L) { \
+		__cyx_bitvec_##isa a; \
+		memcpy(&a, x + i, W); \
+		for (size_t l = 0; l < L; ++l) { res += __builtin_popcountll(a[l]); } \
+	} \
+	for (; i < n; ++i) { res += __builtin_popcountll(x[i]); } \
+	return res; \
+}
+
+__CYX_DEFINE_BITMAP_KERNELS(base, 16)
+#ifdef __CYX_X86
+__CYX_DEFINE_BITMAP_KERNELS(avx2, 32)
+__CYX_DEFINE_BITMAP_KERNELS(avx512, 64)
+#define __CYX_BITMAP_CALL(fn, ...) (__cyx_has_avx512() ? __cyx_bitmap_##fn##_avx512(__VA_ARGS__) : \
+		__cyx_has_avx2() ? __cyx_bitmap_##fn##_avx2(__VA_ARGS__) : __cyx_bitmap_##fn##_base(__VA_ARGS__))
+#else
+#define __CYX_BITMAP_CALL(fn, ...) __cyx_bitmap_##fn##_base(__VA_ARGS__)
+#endif // __CYX_X86
+
+// clears the bits of the last word that are past the size
+static inline void __cyx_bitmap_mask_tail(size_t* bitmap) {
+	size_t size = cyx_bitmap_size(bitmap);
+	if (size % __CYX_BITMAP_WORD_BITS) { bitmap[size / __CYX_BITMAP_WORD_BITS] &= ~(size_t)0 >> (__CYX_BITMAP_WORD_BITS - size % __CYX_BITMAP_WORD_BITS); }
+}
+
+// `keep1`/`keep2` tell if the words of the first/second operand past the end of the other one survive the op
+#define __CYX_DEFINE_BITMAP_API(name, keep1, keep2) \
+size_t* cyx_bitmap_##name(const size_t* const bitmap1, const size_t* const bitmap2) { \
+	if (!bitmap1 || !bitmap2) { return NULL; } \
+	size_t size1 = cyx_bitmap_size(bitmap1), size2 = cyx_bitmap_size(bitmap2); \
+	size_t* res = cyx_bitmap_new(size1 > size2 ? size1 : size2); \
+	if (!res) { return NULL; } \
+	size_t words1 = __CYX_BITMAP_WORDS(size1), words2 = __CYX_BITMAP_WORDS(size2), common = words1 < words2 ? words1 : words2; \
+	__CYX_BITMAP_CALL(name, res, bitmap1, bitmap2, common); \
+	if (keep1 && words1 > common) { memcpy(res + common, bitmap1 + common, (words1 - common) * sizeof(size_t)); } \
+	if (keep2 && words2 > common) { memcpy(res + common, bitmap2 + common, (words2 - common) * sizeof(size_t)); } \
+	return res; \
+} \
+size_t* cyx_bitmap_##name##_self(size_t* self, const size_t* const other) { \
+	if (!self || !other) { return NULL; } \
+	size_t words1 = __CYX_BITMAP_WORDS(cyx_bitmap_size(self)), words2 = __CYX_BITMAP_WORDS(cyx_bitmap_size(other)); \
+	size_t common = words1 < words2 ? words1 : words2; \
+	__CYX_BITMAP_CALL(name, self, self, other, common); \
+	if (!keep1 && words1 > common) { memset(self + common, 0, (words1 - common) * sizeof(size_t)); } \
+	if (cyx_bitmap_size(other) > cyx_bitmap_size(self)) { __cyx_bitmap_mask_tail(self); } \
+	return self; \
+} \
+size_t cyx_bitmap_##name##_count(const size_t* const bitmap1, const size_t* const bitmap2) { \
+	assert(bitmap1 && bitmap2); \
+	size_t words1 = __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap1)), words2 = __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap2)); \
+	size_t common = words1 < words2 ? words1 : words2; \
+	size_t res = __CYX_BITMAP_CALL(name##_count, bitmap1, bitmap2, common); \
+	if (keep1 && words1 > common) { res += __CYX_BITMAP_CALL(popcount, bitmap1 + common, words1 - common); } \
+	if (keep2 && words2 > common) { res += __CYX_BITMAP_CALL(popcount, bitmap2 + common, words2 - common); } \
+	return res; \
+}
+
+__CYX_DEFINE_BITMAP_API(and, 0, 0)
+__CYX_DEFINE_BITMAP_API(or, 1, 1)
+__CYX_DEFINE_BITMAP_API(xor, 1, 1)
+__CYX_DEFINE_BITMAP_API(andnot, 1, 0)
+
+#undef __CYX_DEFINE_BITMAP_API
+#undef __CYX_DEFINE_BITMAP_KERNELS
+#undef __CYX_DEFINE_BITMAP_OP
+
+size_t* cyx_bitmap_not(const size_t* const bitmap) {
+	if (!bitmap) { return NULL; }
+	size_t* res = cyx_bitmap_copy(bitmap);
+	return res ? cyx_bitmap_not_self(res) : NULL;
+}
+size_t* cyx_bitmap_not_self(size_t* self) {
+	if (!self) { return NULL; }
+	size_t size = cyx_bitmap_size(self), words = __CYX_BITMAP_WORDS(size);
+	__CYX_BITMAP_CALL(not, self, self, words);
+	__cyx_bitmap_mask_tail(self);
+	return self;
+}
+
+// words per block, so the partial result stays in L1 while every operand is folded into it
+#define __CYX_BITMAP_AND_BLOCK 512
+
+size_t* cyx_bitmap_and_many(const size_t* const* bitmaps, size_t n) {
+	if (!bitmaps || !n || !bitmaps[0]) { return NULL; }
+	size_t size = cyx_bitmap_size(bitmaps[0]), min_size = size;
+	for (size_t i = 1; i < n; ++i) {
+		if (!bitmaps[i]) { return NULL; }
+		if (cyx_bitmap_size(bitmaps[i]) > size) { size = cyx_bitmap_size(bitmaps[i]); }
+		if (cyx_bitmap_size(bitmaps[i]) < min_size) { min_size = cyx_bitmap_size(bitmaps[i]); }
+	}
+	if (n == 1) { return cyx_bitmap_copy(bitmaps[0]); }
+
+	// past the shortest operand the intersection is empty
+	size_t* res = cyx_bitmap_new(size);
+	if (!res) { return NULL; }
+	size_t words = __CYX_BITMAP_WORDS(min_size);
+	for (size_t from = 0; from < words; from += __CYX_BITMAP_AND_BLOCK) {
+		size_t len = words - from < __CYX_BITMAP_AND_BLOCK ? words - from : __CYX_BITMAP_AND_BLOCK;
+		__CYX_BITMAP_CALL(and, res + from, bitmaps[0] + from, bitmaps[1] + from, len);
+		for (size_t i = 2; i < n; ++i) { __CYX_BITMAP_CALL(and, res + from, res + from, bitmaps[i] + from, len); }
+	}
+	return res;
+}
+
+#undef __CYX_BITMAP_AND_BLOCK
+
+// word indexes and masks of the first and last word of a non-empty range
+static inline void __cyx_bitmap_range(const size_t* bitmap, size_t from, size_t to, size_t* first, size_t* last, size_t* head, size_t* tail) {
+	assert(from <= to && to <= cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	(void)bitmap;
+	*first = from / __CYX_BITMAP_WORD_BITS;
+	*last = (to - 1) / __CYX_BITMAP_WORD_BITS;
+	*head = ~(size_t)0 << (from % __CYX_BITMAP_WORD_BITS);
+	*tail = ~(size_t)0 >> (__CYX_BITMAP_WORD_BITS - 1 - (to - 1) % __CYX_BITMAP_WORD_BITS);
+	if (*first == *last) { *head = *tail = *head & *tail; }
+}
+
+void cyx_bitmap_set_range(size_t* bitmap, size_t from, size_t to) {
+	assert(bitmap);
+	if (from == to) { return; }
+	size_t first, last, head, tail;
+	__cyx_bitmap_range(bitmap, from, to, &first, &last, &head, &tail);
+	bitmap[first] |= head;
+	if (first == last) { return; }
+	memset(bitmap + first + 1, 0xff, (last - first - 1) * sizeof(size_t));
+	bitmap[last] |= tail;
+}
+void cyx_bitmap_clear_range(size_t* bitmap, size_t from, size_t to) {
+	assert(bitmap);
+	if (from == to) { return; }
+	size_t first, last, head, tail;
+	__cyx_bitmap_range(bitmap, from, to, &first, &last, &head, &tail);
+	bitmap[first] &= ~head;
+	if (first == last) { return; }
+	memset(bitmap + first + 1, 0, (last - first - 1) * sizeof(size_t));
+	bitmap[last] &= ~tail;
+}
+void cyx_bitmap_flip_range(size_t* bitmap, size_t from, size_t to) {
+	assert(bitmap);
+	if (from == to) { return; }
+	size_t first, last, head, tail;
+	__cyx_bitmap_range(bitmap, from, to, &first, &last, &head, &tail);
+	bitmap[first] ^= head;
+	if (first == last) { return; }
+	__CYX_BITMAP_CALL(not, bitmap + first + 1, bitmap + first + 1, last - first - 1);
+	bitmap[last] ^= tail;
+}
+int cyx_bitmap_all_in_range(const size_t* const bitmap, size_t from, size_t to) {
+	assert(bitmap);
+	if (from == to) { return 1; }
+	size_t first, last, head, tail;
+	__cyx_bitmap_range(bitmap, from, to, &first, &last, &head, &tail);
+	if ((bitmap[first] & head) != head || (bitmap[last] & tail) != tail) { return 0; }
+	for (size_t i = first + 1; i < last; ++i) {
+		if (~bitmap[i]) { return 0; }
+	}
+	return 1;
+}
+int cyx_bitmap_any_in_range(const size_t* const bitmap, size_t from, size_t to) {
+	assert(bitmap);
+	if (from == to) { return 0; }
+	size_t first, last, head, tail;
+	__cyx_bitmap_range(bitmap, from, to, &first, &last, &head, &tail);
+	if ((bitmap[first] & head) || (bitmap[last] & tail)) { return 1; }
+	for (size_t i = first + 1; i < last; ++i) {
+		if (bitmap[i]) { return 1; }
+	}
+	return 0;
+}
+
+int cyx_bitmap_atomic_get(const size_t* const bitmap, size_t pos) {
+	assert(bitmap);
+	assert(pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	size_t word = __atomic_load_n(&bitmap[pos / __CYX_BITMAP_WORD_BITS], __ATOMIC_ACQUIRE);
+	return (word >> (pos % __CYX_BITMAP_WORD_BITS)) & 1;
+}
+int cyx_bitmap_test_and_set(size_t* bitmap, size_t pos) {
+	assert(bitmap);
+	assert(pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	size_t bit = (size_t)1 << (pos % __CYX_BITMAP_WORD_BITS);
+	return (__atomic_fetch_or(&bitmap[pos / __CYX_BITMAP_WORD_BITS], bit, __ATOMIC_ACQ_REL) & bit) != 0;
+}
+int cyx_bitmap_test_and_clear(size_t* bitmap, size_t pos) {
+	assert(bitmap);
+	assert(pos < cyx_bitmap_size(bitmap) && "ERROR: Trying to access an out of range value!");
+	size_t bit = (size_t)1 << (pos % __CYX_BITMAP_WORD_BITS);
+	return (__atomic_fetch_and(&bitmap[pos / __CYX_BITMAP_WORD_BITS], ~bit, __ATOMIC_ACQ_REL) & bit) != 0;
+}
+size_t cyx_bitmap_fetch_or(size_t* bitmap, size_t word, size_t mask) {
+	assert(bitmap);
+	assert(word < __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap)) && "ERROR: Trying to access an out of range value!");
+	size_t size = cyx_bitmap_size(bitmap);
+	if (word == size / __CYX_BITMAP_WORD_BITS) { mask &= ~(~(size_t)0 << (size % __CYX_BITMAP_WORD_BITS)); }
+	return __atomic_fetch_or(&bitmap[word], mask, __ATOMIC_ACQ_REL);
+}
+size_t cyx_bitmap_claim_first_zero(size_t* bitmap, size_t hint) {
+	assert(bitmap);
+	size_t size = cyx_bitmap_size(bitmap), words = __CYX_BITMAP_WORDS(size);
+	if (!size) { return size; }
+	if (hint >= size) { hint = 0; }
+
+	// the hint's word is visited twice, first from the hint and at the end of the wrap for the bits before it
+	size_t start = hint / __CYX_BITMAP_WORD_BITS;
+	for (size_t n = 0; n <= words; ++n) {
+		size_t i = (start + n) % words;
+		size_t valid = ~(size_t)0;
+		if (i == words - 1 && size % __CYX_BITMAP_WORD_BITS) { valid >>= __CYX_BITMAP_WORD_BITS - size % __CYX_BITMAP_WORD_BITS; }
+		if (!n) { valid &= ~(size_t)0 << (hint % __CYX_BITMAP_WORD_BITS); }
+
+		size_t word = __atomic_load_n(&bitmap[i], __ATOMIC_RELAXED);
+		while (~word & valid) {
+			size_t bit = ~word & valid & -(~word & valid);
+			if (__atomic_compare_exchange_n(&bitmap[i], &word, word | bit, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+				return i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(bit);
+			}
+		}
+	}
+	return size;
+}
+
+size_t cyx_bitmap_count(const size_t* const bitmap) {
+	assert(bitmap);
+	return __CYX_BITMAP_CALL(popcount, bitmap, __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap)));
+}
+size_t cyx_bitmap_find_first_set(const size_t* const bitmap) {
+	return cyx_bitmap_next_set(bitmap, 0);
+}
+size_t cyx_bitmap_find_first_zero(const size_t* const bitmap) {
+	assert(bitmap);
+	size_t size = cyx_bitmap_size(bitmap), words = __CYX_BITMAP_WORDS(size);
+	for (size_t i = 0; i < words; ++i) {
+		if (~bitmap[i]) {
+			size_t pos = i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(~bitmap[i]);
+			return pos < size ? pos : size;
+		}
+	}
+	return size;
+}
+size_t cyx_bitmap_next_set(const size_t* const bitmap, size_t from) {
+	assert(bitmap);
+	size_t size = cyx_bitmap_size(bitmap);
+	if (from >= size) { return size; }
+
+	size_t i = from / __CYX_BITMAP_WORD_BITS, words = __CYX_BITMAP_WORDS(size);
+	size_t word = bitmap[i] & (~(size_t)0 << (from % __CYX_BITMAP_WORD_BITS));
+	while (!word) {
+		if (++i == words) { return size; }
+		word = bitmap[i];
+	}
+	size_t pos = i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(word);
+	return pos < size ? pos : size;
+}
+size_t cyx_bitmap_rank(const size_t* const bitmap, size_t pos) {
+	assert(bitmap);
+	if (pos > cyx_bitmap_size(bitmap)) { pos = cyx_bitmap_size(bitmap); }
+
+	size_t words = pos / __CYX_BITMAP_WORD_BITS, res = 0;
+	for (size_t i = 0; i < words; ++i) { res += __builtin_popcountll(bitmap[i]); }
+	if (pos % __CYX_BITMAP_WORD_BITS) {
+		res += __builtin_popcountll(bitmap[words] & (~(size_t)0 >> (__CYX_BITMAP_WORD_BITS - pos % __CYX_BITMAP_WORD_BITS)));
+	}
+	return res;
+}
+size_t cyx_bitmap_select(const size_t* const bitmap, size_t k) {
+	assert(bitmap);
+	size_t size = cyx_bitmap_size(bitmap), words = __CYX_BITMAP_WORDS(size);
+	for (size_t i = 0; i < words; ++i) {
+		size_t count = __builtin_popcountll(bitmap[i]);
+		if (k >= count) {
+			k -= count;
+			continue;
+		}
+		size_t word = bitmap[i];
+		while (k--) { word &= word - 1; }
+		size_t pos = i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(word);
+		return pos < size ? pos : size;
+	}
+	return size;
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * Roaring Bitmap
+ */
+
+#if __CYX_CLOSE_FOLD
+
+// the 32-bit universe is split on the high 16 bits, every chunk keeps its low 16 bits in whichever
+// container is smallest: a sorted array (sparse), a bitset (dense) or sorted runs (clustered)
+typedef struct {
+	void* data;
+	uint32_t card;
+	uint32_t len;
+	uint32_t cap;
+	uint16_t key;
+	uint8_t type;
+} __CyxRoaringContainer;
+
+typedef struct {
+	__CyxRoaringContainer* containers;
+	uint32_t len;
+	uint32_t cap;
+} CyxRoaring;
+
+typedef struct {
+	const CyxRoaring* __roaring;
+	uint32_t __container;
+	uint32_t __pos;
+	uint32_t __off;
+	uint32_t value;
+} CyxRoaringIter;
+
+CyxRoaring* cyx_roaring_new(void);
+CyxRoaring* cyx_roaring_copy(const CyxRoaring* const roaring);
+void cyx_roaring_free(CyxRoaring* roaring);
+int cyx_roaring_add(CyxRoaring* roaring, uint32_t val);
+int cyx_roaring_contains(const CyxRoaring* const roaring, uint32_t val);
+size_t cyx_roaring_cardinality(const CyxRoaring* const roaring);
+size_t cyx_roaring_memory(const CyxRoaring* const roaring);
+// re-picks the smallest container for every chunk, `add` alone never creates run containers
+void cyx_roaring_optimize(CyxRoaring* roaring);
+void cyx_roaring_print(const CyxRoaring* const roaring);
+
+CyxRoaring* cyx_roaring_and(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2);
+CyxRoaring* cyx_roaring_or(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2);
+CyxRoaring* cyx_roaring_andnot(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2);
+
+CyxRoaringIter cyx_roaring_iter(const CyxRoaring* const roaring);
+int cyx_roaring_next(CyxRoaringIter* it);
+
+CyxRoaring* cyx_roaring_from_bitmap(const size_t* const bitmap);
+// `size` of 0 fits the bitmap to the largest value
+size_t* cyx_roaring_to_bitmap(const CyxRoaring* const roaring, size_t size);
+
+// native byte order, `deserialize` returns NULL for truncated or malformed input
+size_t cyx_roaring_serialized_size(const CyxRoaring* const roaring);
+size_t cyx_roaring_serialize(const CyxRoaring* const roaring, void* buf);
+CyxRoaring* cyx_roaring_deserialize(const void* buf, size_t bytes);
+
+#define cyx_roaring_foreach(val, roaring) for (CyxRoaringIter val = cyx_roaring_iter(roaring); cyx_roaring_next(&val); )
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define roaring_foreach(val, roaring) cyx_roaring_foreach(val, roaring)
+
+#define roaring_new cyx_roaring_new
+#define roaring_copy cyx_roaring_copy
+#define roaring_free cyx_roaring_free
+#define roaring_add cyx_roaring_add
+#define roaring_contains cyx_roaring_contains
+#define roaring_cardinality cyx_roaring_cardinality
+#define roaring_memory cyx_roaring_memory
+#define roaring_optimize cyx_roaring_optimize
+#define roaring_print cyx_roaring_print
+
+#define roaring_and cyx_roaring_and
+#define roaring_or cyx_roaring_or
+#define roaring_andnot cyx_roaring_andnot
+
+#define roaring_iter cyx_roaring_iter
+#define roaring_next cyx_roaring_next
+
+#define roaring_from_bitmap cyx_roaring_from_bitmap
+#define roaring_to_bitmap cyx_roaring_to_bitmap
+
+#define roaring_serialized_size cyx_roaring_serialized_size
+#define roaring_serialize cyx_roaring_serialize
+#define roaring_deserialize cyx_roaring_deserialize
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+#define __CYX_ROARING_ARRAY 0
+#define __CYX_ROARING_BITSET 1
+#define __CYX_ROARING_RUN 2
+#define __CYX_ROARING_CHUNK_BITS 65536
+#define __CYX_ROARING_WORDS (__CYX_ROARING_CHUNK_BITS / __CYX_BITMAP_WORD_BITS)
+// past this an array is bigger than a bitset
+#define __CYX_ROARING_ARRAY_MAX 4096
+#define __CYX_ROARING_MAGIC 0x52585943u
+
+#define __cyx_roaring_word_get(words, pos) (((words)[(pos) / __CYX_BITMAP_WORD_BITS] >> ((pos) % __CYX_BITMAP_WORD_BITS)) & 1)
+#define __cyx_roaring_word_set(words, pos) ((words)[(pos) / __CYX_BITMAP_WORD_BITS] |= (size_t)1 << ((pos) % __CYX_BITMAP_WORD_BITS))
+
+static size_t __cyx_roaring_data_bytes(uint8_t type, uint32_t n) {
+	switch (type) {
+		case __CYX_ROARING_ARRAY: return n * sizeof(uint16_t);
+		case __CYX_ROARING_BITSET: return __CYX_ROARING_WORDS * sizeof(size_t);
+		default: return 2 * n * sizeof(uint16_t);
+	}
+}
+
+// index of the container with `key`, or where it would be inserted
+static uint32_t __cyx_roaring_find(const CyxRoaring* roaring, uint16_t key, int* found) {
+	uint32_t lo = 0, hi = roaring->len;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (roaring->containers[mid].key < key) { lo = mid + 1; } else { hi = mid; }
+	}
+	*found = lo < roaring->len && roaring->containers[lo].key == key;
+	return lo;
+}
+// first element of the sorted `vals` (stride `step`) not less than `val`
+static uint32_t __cyx_roaring_lower_bound(const uint16_t* vals, uint32_t n, size_t step, uint16_t val) {
+	uint32_t lo = 0, hi = n;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (vals[mid * step] < val) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+static void __cyx_roaring_push(CyxRoaring* roaring, __CyxRoaringContainer c) {
+	if (roaring->len == roaring->cap) {
+		roaring->cap = roaring->cap ? roaring->cap * 2 : 4;
+		roaring->containers = realloc(roaring->containers, roaring->cap * sizeof(__CyxRoaringContainer));
+		assert(roaring->containers && "ERROR: Out of memory!");
+	}
+	roaring->containers[roaring->len++] = c;
+}
+
+static int __cyx_roaring_container_contains(const __CyxRoaringContainer* c, uint16_t low) {
+	const uint16_t* vals = c->data;
+	switch (c->type) {
+		case __CYX_ROARING_ARRAY: {
+			uint32_t i = __cyx_roaring_lower_bound(vals, c->len, 1, low);
+			return i < c->len && vals[i] == low;
+		}
+		case __CYX_ROARING_BITSET: return __cyx_roaring_word_get((const size_t*)c->data, low);
+		default: {
+			uint32_t i = __cyx_roaring_lower_bound(vals, c->len, 2, low);
+			if (i < c->len && vals[2 * i] == low) { return 1; }
+			return i && low - vals[2 * (i - 1)] <= vals[2 * i - 1];
+		}
+	}
+}
+static void __cyx_roaring_container_to_words(const __CyxRoaringContainer* c, size_t* words) {
+	if (c->type == __CYX_ROARING_BITSET) {
+		memcpy(words, c->data, __CYX_ROARING_WORDS * sizeof(size_t));
+		return;
+	}
+	memset(words, 0, __CYX_ROARING_WORDS * sizeof(size_t));
+	const uint16_t* vals = c->data;
+	if (c->type == __CYX_ROARING_ARRAY) {
+		for (uint32_t i = 0; i < c->len; ++i) { __cyx_roaring_word_set(words, vals[i]); }
+		return;
+	}
+	for (uint32_t i = 0; i < c->len; ++i) {
+		for (uint32_t pos = vals[2 * i], end = pos + vals[2 * i + 1]; pos <= end; ++pos) { __cyx_roaring_word_set(words, pos); }
+	}
+}
+// next position from `from` whose bit equals `bit`, or the chunk size
+static uint32_t __cyx_roaring_words_next(const size_t* words, uint32_t from, int bit) {
+	if (from >= __CYX_ROARING_CHUNK_BITS) { return __CYX_ROARING_CHUNK_BITS; }
+	size_t i = from / __CYX_BITMAP_WORD_BITS;
+	size_t flip = bit ? 0 : ~(size_t)0;
+	size_t word = (words[i] ^ flip) & (~(size_t)0 << (from % __CYX_BITMAP_WORD_BITS));
+	while (!word) {
+		if (++i == __CYX_ROARING_WORDS) { return __CYX_ROARING_CHUNK_BITS; }
+		word = words[i] ^ flip;
+	}
+	return i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(word);
+}
+// builds the smallest container holding `words`, returns 0 when it's empty
+static int __cyx_roaring_container_from_words(__CyxRoaringContainer* c, const size_t* words, uint16_t key) {
+	size_t card = __CYX_BITMAP_CALL(popcount, words, __CYX_ROARING_WORDS), runs = 0, carry = 0;
+	if (!card) { return 0; }
+	for (size_t i = 0; i < __CYX_ROARING_WORDS; ++i) {
+		runs += __builtin_popcountll(words[i] & ~((words[i] << 1) | carry));
+		carry = words[i] >> (__CYX_BITMAP_WORD_BITS - 1);
+	}
+
+	*c = (__CyxRoaringContainer){ .card = card, .key = key, .type = __CYX_ROARING_BITSET };
+	size_t best = __cyx_roaring_data_bytes(__CYX_ROARING_BITSET, 0);
+	if (__cyx_roaring_data_bytes(__CYX_ROARING_RUN, runs) < best) {
+		c->type = __CYX_ROARING_RUN;
+		c->len = c->cap = runs;
+		best = __cyx_roaring_data_bytes(__CYX_ROARING_RUN, runs);
+	}
+	if (__cyx_roaring_data_bytes(__CYX_ROARING_ARRAY, card) < best) {
+		c->type = __CYX_ROARING_ARRAY;
+		c->len = c->cap = card;
+	}
+	c->data = malloc(__cyx_roaring_data_bytes(c->type, c->cap));
+	assert(c->data && "ERROR: Out of memory!");
+
+	uint16_t* vals = c->data;
+	switch (c->type) {
+		case __CYX_ROARING_ARRAY: {
+			size_t n = 0;
+			for (size_t i = 0; i < __CYX_ROARING_WORDS; ++i) {
+				for (size_t word = words[i]; word; word &= word - 1) { vals[n++] = i * __CYX_BITMAP_WORD_BITS + __builtin_ctzll(word); }
+			}
+		} break;
+		case __CYX_ROARING_BITSET: memcpy(c->data, words, __CYX_ROARING_WORDS * sizeof(size_t)); break;
+		default: {
+			size_t n = 0;
+			for (uint32_t start = __cyx_roaring_words_next(words, 0, 1); start < __CYX_ROARING_CHUNK_BITS; ) {
+				uint32_t end = __cyx_roaring_words_next(words, start, 0);
+				vals[2 * n] = start;
+				vals[2 * n + 1] = end - start - 1;
+				++n;
+				start = __cyx_roaring_words_next(words, end, 1);
+			}
+		} break;
+	}
+	return 1;
+}
+static uint32_t __cyx_roaring_container_max(const __CyxRoaringContainer* c) {
+	const uint16_t* vals = c->data;
+	switch (c->type) {
+		case __CYX_ROARING_ARRAY: return vals[c->len - 1];
+		case __CYX_ROARING_BITSET: {
+			const size_t* words = c->data;
+			size_t i = __CYX_ROARING_WORDS - 1;
+			while (!words[i]) { --i; }
+			return i * __CYX_BITMAP_WORD_BITS + __CYX_BITMAP_WORD_BITS - 1 - __builtin_clzll(words[i]);
+		}
+		default: return vals[2 * c->len - 2] + (uint32_t)vals[2 * c->len - 1];
+	}
+}
+static void __cyx_roaring_container_to_bitset(__CyxRoaringContainer* c) {
+	size_t* words = malloc(__CYX_ROARING_WORDS * sizeof(size_t));
+	assert(words && "ERROR: Out of memory!");
+	__cyx_roaring_container_to_words(c, words);
+	free(c->data);
+	c->data = words;
+	c->type = __CYX_ROARING_BITSET;
+	c->len = c->cap = 0;
+}
+static __CyxRoaringContainer __cyx_roaring_container_copy(const __CyxRoaringContainer* c) {
+	__CyxRoaringContainer res = *c;
+	res.cap = c->len;
+	size_t bytes = __cyx_roaring_data_bytes(c->type, res.cap);
+	res.data = malloc(bytes ? bytes : 1);
+	assert(res.data && "ERROR: Out of memory!");
+	memcpy(res.data, c->data, bytes);
+	return res;
+}
+// grows an array or run container to hold `n` more entries
+static void __cyx_roaring_container_grow(__CyxRoaringContainer* c, uint32_t n) {
+	if (c->len + n <= c->cap) { return; }
+	c->cap = c->cap ? c->cap * 2 : 4;
+	if (c->cap < c->len + n) { c->cap = c->len + n; }
+	c->data = realloc(c->data, __cyx_roaring_data_bytes(c->type, c->cap));
+	assert(c->data && "ERROR: Out of memory!");
+}
+static int __cyx_roaring_container_add(__CyxRoaringContainer* c, uint16_t low) {
+	uint16_t* vals = c->data;
+	switch (c->type) {
+		case __CYX_ROARING_ARRAY: {
+			uint32_t i = __cyx_roaring_lower_bound(vals, c->len, 1, low);
+			if (i < c->len && vals[i] == low) { return 0; }
+			if (c->len == __CYX_ROARING_ARRAY_MAX) {
+				__cyx_roaring_container_to_bitset(c);
+				return __cyx_roaring_container_add(c, low);
+			}
+			__cyx_roaring_container_grow(c, 1);
+			vals = c->data;
+			memmove(vals + i + 1, vals + i, (c->len - i) * sizeof(uint16_t));
+			vals[i] = low;
+			++c->len;
+		} break;
+		case __CYX_ROARING_BITSET: {
+			if (__cyx_roaring_word_get((size_t*)c->data, low)) { return 0; }
+			__cyx_roaring_word_set((size_t*)c->data, low);
+		} break;
+		default: {
+			// runs are (start, length - 1) pairs, `i` is the first run starting after `low`
+			uint32_t i = __cyx_roaring_lower_bound(vals, c->len, 2, low);
+			if (i < c->len && vals[2 * i] == low) { return 0; }
+			if (i && low - vals[2 * (i - 1)] <= vals[2 * i - 1]) { return 0; }
+
+			int extends_prev = i && low - vals[2 * (i - 1)] == vals[2 * i - 1] + 1;
+			int extends_next = i < c->len && vals[2 * i] == low + 1;
+			if (extends_prev && extends_next) {
+				vals[2 * i - 1] += vals[2 * i + 1] + 2;
+				memmove(vals + 2 * i, vals + 2 * (i + 1), 2 * (c->len - i - 1) * sizeof(uint16_t));
+				--c->len;
+			} else if (extends_prev) {
+				++vals[2 * i - 1];
+			} else if (extends_next) {
+				--vals[2 * i];
+				++vals[2 * i + 1];
+			} else {
+				if (__cyx_roaring_data_bytes(__CYX_ROARING_RUN, c->len + 1) > __cyx_roaring_data_bytes(__CYX_ROARING_BITSET, 0)) {
+					__cyx_roaring_container_to_bitset(c);
+					return __cyx_roaring_container_add(c, low);
+				}
+				__cyx_roaring_container_grow(c, 1);
+				vals = c->data;
+				memmove(vals + 2 * (i + 1), vals + 2 * i, 2 * (c->len - i) * sizeof(uint16_t));
+				vals[2 * i] = low;
+				vals[2 * i + 1] = 0;
+				++c->len;
+			}
+		} break;
+	}
+	++c->card;
+	return 1;
+}
+
+CyxRoaring* cyx_roaring_new(void) {
+	return calloc(1, sizeof(CyxRoaring));
+}
+CyxRoaring* cyx_roaring_copy(const CyxRoaring* const roaring) {
+	assert(roaring);
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	for (uint32_t i = 0; i < roaring->len; ++i) { __cyx_roaring_push(res, __cyx_roaring_container_copy(&roaring->containers[i])); }
+	return res;
+}
+void cyx_roaring_free(CyxRoaring* roaring) {
+	if (!roaring) { return; }
+	for (uint32_t i = 0; i < roaring->len; ++i) { free(roaring->containers[i].data); }
+	free(roaring->containers);
+	free(roaring);
+}
+int cyx_roaring_add(CyxRoaring* roaring, uint32_t val) {
+	assert(roaring);
+	int found;
+	uint32_t i = __cyx_roaring_find(roaring, val >> 16, &found);
+	if (!found) {
+		__cyx_roaring_push(roaring, (__CyxRoaringContainer){ 0 });
+		memmove(roaring->containers + i + 1, roaring->containers + i, (roaring->len - i - 1) * sizeof(__CyxRoaringContainer));
+		roaring->containers[i] = (__CyxRoaringContainer){ .key = val >> 16, .type = __CYX_ROARING_ARRAY };
+	}
+	return __cyx_roaring_container_add(&roaring->containers[i], val & 0xffff);
+}
+int cyx_roaring_contains(const CyxRoaring* const roaring, uint32_t val) {
+	assert(roaring);
+	int found;
+	uint32_t i = __cyx_roaring_find(roaring, val >> 16, &found);
+	return found && __cyx_roaring_container_contains(&roaring->containers[i], val & 0xffff);
+}
+size_t cyx_roaring_cardinality(const CyxRoaring* const roaring) {
+	assert(roaring);
+	size_t res = 0;
+	for (uint32_t i = 0; i < roaring->len; ++i) { res += roaring->containers[i].card; }
+	return res;
+}
+size_t cyx_roaring_memory(const CyxRoaring* const roaring) {
+	assert(roaring);
+	size_t res = sizeof(CyxRoaring) + roaring->cap * sizeof(__CyxRoaringContainer);
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		res += __cyx_roaring_data_bytes(roaring->containers[i].type, roaring->containers[i].cap);
+	}
+	return res;
+}
+void cyx_roaring_optimize(CyxRoaring* roaring) {
+	assert(roaring);
+	size_t words[__CYX_ROARING_WORDS];
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		__CyxRoaringContainer* c = &roaring->containers[i];
+		__cyx_roaring_container_to_words(c, words);
+		free(c->data);
+		__cyx_roaring_container_from_words(c, words, c->key);
+	}
+}
+void cyx_roaring_print(const CyxRoaring* const roaring) {
+	assert(roaring);
+	printf("{");
+	int first = 1;
+	cyx_roaring_foreach(it, roaring) {
+		printf(first ? "%u" : ", %u", it.value);
+		first = 0;
+	}
+	printf("}");
+}
+
+static void __cyx_roaring_container_filter(CyxRoaring* res, const __CyxRoaringContainer* arr, const __CyxRoaringContainer* other, int keep) {
+	__CyxRoaringContainer c = { .key = arr->key, .type = __CYX_ROARING_ARRAY };
+	const uint16_t* vals = arr->data;
+	for (uint32_t i = 0; i < arr->len; ++i) {
+		if (__cyx_roaring_container_contains(other, vals[i]) == keep) {
+			__cyx_roaring_container_grow(&c, 1);
+			((uint16_t*)c.data)[c.len++] = vals[i];
+		}
+	}
+	c.card = c.len;
+	if (c.card) { __cyx_roaring_push(res, c); }
+}
+// `op` is one of the bitmap kernels, both containers are expanded to words first
+#define __cyx_roaring_container_op(res, c1, c2, op) do { \
+	size_t __words1[__CYX_ROARING_WORDS], __words2[__CYX_ROARING_WORDS]; \
+	__cyx_roaring_container_to_words(c1, __words1); \
+	__cyx_roaring_container_to_words(c2, __words2); \
+	__CYX_BITMAP_CALL(op, __words1, __words1, __words2, __CYX_ROARING_WORDS); \
+	__CyxRoaringContainer __c; \
+	if (__cyx_roaring_container_from_words(&__c, __words1, (c1)->key)) { __cyx_roaring_push(res, __c); } \
+} while (0)
+
+CyxRoaring* cyx_roaring_and(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2) {
+	assert(roaring1 && roaring2);
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	for (uint32_t i = 0, j = 0; i < roaring1->len && j < roaring2->len; ) {
+		const __CyxRoaringContainer* c1 = &roaring1->containers[i], * c2 = &roaring2->containers[j];
+		if (c1->key < c2->key) { ++i; continue; }
+		if (c2->key < c1->key) { ++j; continue; }
+		if (c1->type == __CYX_ROARING_ARRAY) {
+			__cyx_roaring_container_filter(res, c1, c2, 1);
+		} else if (c2->type == __CYX_ROARING_ARRAY) {
+			__cyx_roaring_container_filter(res, c2, c1, 1);
+		} else {
+			__cyx_roaring_container_op(res, c1, c2, and);
+		}
+		++i, ++j;
+	}
+	return res;
+}
+// sparse chunks stay cheap: arrays are merged and array values are added straight into a copy of a
+// bitset or run container, only two non-array containers get expanded to words
+static void __cyx_roaring_container_or(CyxRoaring* res, const __CyxRoaringContainer* c1, const __CyxRoaringContainer* c2) {
+	if (c1->type != __CYX_ROARING_ARRAY && c2->type != __CYX_ROARING_ARRAY) {
+		__cyx_roaring_container_op(res, c1, c2, or);
+		return;
+	}
+	if (c1->type == __CYX_ROARING_ARRAY && c2->type == __CYX_ROARING_ARRAY) {
+		const uint16_t* vals1 = c1->data, * vals2 = c2->data;
+		__CyxRoaringContainer c = { .key = c1->key, .type = __CYX_ROARING_ARRAY };
+		__cyx_roaring_container_grow(&c, c1->len + c2->len);
+		uint16_t* out = c.data;
+		uint32_t i = 0, j = 0;
+		while (i < c1->len && j < c2->len) {
+			if (vals1[i] < vals2[j]) {
+				out[c.len++] = vals1[i++];
+			} else if (vals2[j] < vals1[i]) {
+				out[c.len++] = vals2[j++];
+			} else {
+				out[c.len++] = vals1[i++];
+				++j;
+			}
+		}
+		while (i < c1->len) { out[c.len++] = vals1[i++]; }
+		while (j < c2->len) { out[c.len++] = vals2[j++]; }
+		c.card = c.len;
+		if (c.len > __CYX_ROARING_ARRAY_MAX) { __cyx_roaring_container_to_bitset(&c); }
+		__cyx_roaring_push(res, c);
+		return;
+	}
+
+	const __CyxRoaringContainer* arr = c1->type == __CYX_ROARING_ARRAY ? c1 : c2;
+	__CyxRoaringContainer c = __cyx_roaring_container_copy(arr == c1 ? c2 : c1);
+	const uint16_t* vals = arr->data;
+	for (uint32_t i = 0; i < arr->len; ++i) { __cyx_roaring_container_add(&c, vals[i]); }
+	__cyx_roaring_push(res, c);
+}
+
+CyxRoaring* cyx_roaring_or(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2) {
+	assert(roaring1 && roaring2);
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	for (uint32_t i = 0, j = 0; i < roaring1->len || j < roaring2->len; ) {
+		const __CyxRoaringContainer* c1 = i < roaring1->len ? &roaring1->containers[i] : NULL;
+		const __CyxRoaringContainer* c2 = j < roaring2->len ? &roaring2->containers[j] : NULL;
+		if (!c2 || (c1 && c1->key < c2->key)) {
+			__cyx_roaring_push(res, __cyx_roaring_container_copy(c1));
+			++i;
+		} else if (!c1 || c2->key < c1->key) {
+			__cyx_roaring_push(res, __cyx_roaring_container_copy(c2));
+			++j;
+		} else {
+			__cyx_roaring_container_or(res, c1, c2);
+			++i, ++j;
+		}
+	}
+	return res;
+}
+CyxRoaring* cyx_roaring_andnot(const CyxRoaring* const roaring1, const CyxRoaring* const roaring2) {
+	assert(roaring1 && roaring2);
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	for (uint32_t i = 0, j = 0; i < roaring1->len; ++i) {
+		const __CyxRoaringContainer* c1 = &roaring1->containers[i];
+		while (j < roaring2->len && roaring2->containers[j].key < c1->key) { ++j; }
+		const __CyxRoaringContainer* c2 = j < roaring2->len && roaring2->containers[j].key == c1->key ? &roaring2->containers[j] : NULL;
+		if (!c2) {
+			__cyx_roaring_push(res, __cyx_roaring_container_copy(c1));
+		} else if (c1->type == __CYX_ROARING_ARRAY) {
+			__cyx_roaring_container_filter(res, c1, c2, 0);
+		} else {
+			__cyx_roaring_container_op(res, c1, c2, andnot);
+		}
+	}
+	return res;
+}
+
+#undef __cyx_roaring_container_op
+
+CyxRoaringIter cyx_roaring_iter(const CyxRoaring* const roaring) {
+	assert(roaring);
+	return (CyxRoaringIter){ .__roaring = roaring };
+}
+int cyx_roaring_next(CyxRoaringIter* it) {
+	assert(it);
+	const CyxRoaring* roaring = it->__roaring;
+	for (; it->__container < roaring->len; ++it->__container, it->__pos = it->__off = 0) {
+		const __CyxRoaringContainer* c = &roaring->containers[it->__container];
+		const uint16_t* vals = c->data;
+		uint32_t low;
+		if (c->type == __CYX_ROARING_ARRAY) {
+			if (it->__pos >= c->len) { continue; }
+			low = vals[it->__pos++];
+		} else if (c->type == __CYX_ROARING_BITSET) {
+			low = __cyx_roaring_words_next(c->data, it->__pos, 1);
+			if (low >= __CYX_ROARING_CHUNK_BITS) { continue; }
+			it->__pos = low + 1;
+		} else {
+			if (it->__pos >= c->len) { continue; }
+			low = vals[2 * it->__pos] + it->__off;
+			if (it->__off++ == vals[2 * it->__pos + 1]) {
+				++it->__pos;
+				it->__off = 0;
+			}
+		}
+		it->value = (uint32_t)c->key << 16 | low;
+		return 1;
+	}
+	return 0;
+}
+
+CyxRoaring* cyx_roaring_from_bitmap(const size_t* const bitmap) {
+	assert(bitmap);
+	assert(cyx_bitmap_size(bitmap) <= (size_t)UINT32_MAX + 1 && "ERROR: Bitmap is larger than the 32-bit universe!");
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	size_t words = __CYX_BITMAP_WORDS(cyx_bitmap_size(bitmap)), chunk[__CYX_ROARING_WORDS];
+	for (size_t from = 0; from < words; from += __CYX_ROARING_WORDS) {
+		size_t n = words - from < __CYX_ROARING_WORDS ? words - from : __CYX_ROARING_WORDS;
+		const size_t* src = bitmap + from;
+		if (n < __CYX_ROARING_WORDS) {
+			memset(chunk, 0, sizeof(chunk));
+			memcpy(chunk, src, n * sizeof(size_t));
+			src = chunk;
+		}
+		__CyxRoaringContainer c;
+		if (__cyx_roaring_container_from_words(&c, src, from / __CYX_ROARING_WORDS)) { __cyx_roaring_push(res, c); }
+	}
+	return res;
+}
+size_t* cyx_roaring_to_bitmap(const CyxRoaring* const roaring, size_t size) {
+	assert(roaring);
+	size_t max = 0;
+	if (roaring->len) {
+		const __CyxRoaringContainer* c = &roaring->containers[roaring->len - 1];
+		max = ((size_t)c->key << 16) + __cyx_roaring_container_max(c) + 1;
+	}
+	if (!size) { size = max; }
+	assert(max <= size && "ERROR: Roaring bitmap doesn't fit the requested size!");
+
+	size_t* res = cyx_bitmap_new(size);
+	if (!res) { return NULL; }
+	size_t words = __CYX_BITMAP_WORDS(size), chunk[__CYX_ROARING_WORDS];
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		const __CyxRoaringContainer* c = &roaring->containers[i];
+		size_t from = (size_t)c->key * __CYX_ROARING_WORDS;
+		size_t n = words - from < __CYX_ROARING_WORDS ? words - from : __CYX_ROARING_WORDS;
+		__cyx_roaring_container_to_words(c, chunk);
+		memcpy(res + from, chunk, n * sizeof(size_t));
+	}
 	return res;
 }
-size_t* cyx_bitmap_and_self(size_t* self, const size_t* const other) {
-	if (!self || !other || cyx_bitmap_size(self) != cyx_bitmap_size(other)) { return NULL; }
-	size_t size = (cyx_bitmap_size(self) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { self[i] &= other[i]; }
-	return self;
-}
-size_t* cyx_bitmap_or(const size_t* const bitmap1, const size_t* const bitmap2) {
-	if (!bitmap1 || !bitmap2 || cyx_bitmap_size(bitmap1) != cyx_bitmap_size(bitmap2)) { return NULL; }
-	size_t* res = cyx_bitmap_copy(bitmap1);
-	size_t size = (cyx_bitmap_size(res) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { res[i] |= bitmap2[i]; }
+
+// layout: magic, container count, then (key, type, len) per container followed by every container's data
+size_t cyx_roaring_serialized_size(const CyxRoaring* const roaring) {
+	assert(roaring);
+	size_t res = 2 * sizeof(uint32_t) + roaring->len * (2 * sizeof(uint16_t) + sizeof(uint32_t));
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		res += __cyx_roaring_data_bytes(roaring->containers[i].type, roaring->containers[i].len);
+	}
 	return res;
 }
-size_t* cyx_bitmap_or_self(size_t* self, const size_t* const other) {
-	if (!self || !other || cyx_bitmap_size(self) != cyx_bitmap_size(other)) { return NULL; }
-	size_t size = (cyx_bitmap_size(self) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { self[i] |= other[i]; }
-	return self;
+size_t cyx_roaring_serialize(const CyxRoaring* const roaring, void* buf) {
+	assert(roaring && buf);
+	char* p = buf;
+	uint32_t head[2] = { __CYX_ROARING_MAGIC, roaring->len };
+	memcpy(p, head, sizeof(head));
+	p += sizeof(head);
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		const __CyxRoaringContainer* c = &roaring->containers[i];
+		uint16_t desc[2] = { c->key, c->type };
+		memcpy(p, desc, sizeof(desc));
+		memcpy(p + sizeof(desc), &c->len, sizeof(uint32_t));
+		p += sizeof(desc) + sizeof(uint32_t);
+	}
+	for (uint32_t i = 0; i < roaring->len; ++i) {
+		const __CyxRoaringContainer* c = &roaring->containers[i];
+		size_t bytes = __cyx_roaring_data_bytes(c->type, c->len);
+		memcpy(p, c->data, bytes);
+		p += bytes;
+	}
+	return p - (char*)buf;
 }
-size_t* cyx_bitmap_xor(const size_t* const bitmap1, const size_t* const bitmap2) {
-	if (!bitmap1 || !bitmap2 || cyx_bitmap_size(bitmap1) != cyx_bitmap_size(bitmap2)) { return NULL; }
-	size_t* res = cyx_bitmap_copy(bitmap1);
-	size_t size = (cyx_bitmap_size(res) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { res[i] ^= bitmap2[i]; }
+CyxRoaring* cyx_roaring_deserialize(const void* buf, size_t bytes) {
+	assert(buf);
+	const char* p = buf, * end = p + bytes;
+	uint32_t head[2];
+	if (bytes < sizeof(head)) { return NULL; }
+	memcpy(head, p, sizeof(head));
+	p += sizeof(head);
+	size_t desc_size = 2 * sizeof(uint16_t) + sizeof(uint32_t);
+	if (head[0] != __CYX_ROARING_MAGIC || head[1] > __CYX_ROARING_CHUNK_BITS || (size_t)(end - p) < head[1] * desc_size) { return NULL; }
+
+	CyxRoaring* res = cyx_roaring_new();
+	if (!res) { return NULL; }
+	const char* data = p + head[1] * desc_size;
+	for (uint32_t i = 0; i < head[1]; ++i, p += desc_size) {
+		uint16_t desc[2];
+		uint32_t len;
+		memcpy(desc, p, sizeof(desc));
+		memcpy(&len, p + sizeof(desc), sizeof(len));
+		size_t size = __cyx_roaring_data_bytes(desc[1], len);
+		int valid = desc[1] <= __CYX_ROARING_RUN && (!i || desc[0] > res->containers[i - 1].key) &&
+			(desc[1] == __CYX_ROARING_BITSET ? !len : len && len <= __CYX_ROARING_CHUNK_BITS) && (size_t)(end - data) >= size;
+		if (!valid) {
+			cyx_roaring_free(res);
+			return NULL;
+		}
+
+		__CyxRoaringContainer c = { .key = desc[0], .type = desc[1], .len = len, .cap = len };
+		c.data = malloc(size);
+		assert(c.data && "ERROR: Out of memory!");
+		memcpy(c.data, data, size);
+		data += size;
+		const uint16_t* vals = c.data;
+		switch (c.type) {
+			case __CYX_ROARING_ARRAY: {
+				c.card = len;
+				for (uint32_t k = 1; k < len; ++k) { valid &= vals[k - 1] < vals[k]; }
+			} break;
+			case __CYX_ROARING_BITSET: {
+				c.card = __CYX_BITMAP_CALL(popcount, c.data, __CYX_ROARING_WORDS);
+				valid = c.card != 0;
+			} break;
+			default: {
+				for (uint32_t k = 0; k < len; ++k) {
+					valid &= vals[2 * k] + (uint32_t)vals[2 * k + 1] < __CYX_ROARING_CHUNK_BITS && (!k || vals[2 * (k - 1)] + (uint32_t)vals[2 * k - 1] < vals[2 * k]);
+					c.card += vals[2 * k + 1] + 1;
+				}
+			} break;
+		}
+		__cyx_roaring_push(res, c);
+		if (!valid) {
+			cyx_roaring_free(res);
+			return NULL;
+		}
+	}
 	return res;
 }
-size_t* cyx_bitmap_xor_self(size_t* self, const size_t* const other) {
-	if (!self || !other || cyx_bitmap_size(self) != cyx_bitmap_size(other)) { return NULL; }
-	size_t size = (cyx_bitmap_size(self) - 1) / (sizeof(size_t) * 8) + 1; 
-	for (size_t i = 0; i < size; ++i) { self[i] ^= other[i]; }
-	return self;
-}
+
+#undef __cyx_roaring_word_set
+#undef __cyx_roaring_word_get
 
 #endif // CYLIBX_IMPLEMENTATION
 
@@ -1249,6 +4435,26 @@ struct __CyxHashMapFuncParams {
 	void* __key;
 	char defer;
 };
+struct __CyxGroupByParams {
+	const void* __arr;
+	size_t __size_key;
+	size_t __size_value;
+
+	void (*__key_fn)(void*, const void*);
+	size_t (*__hash_fn)(const void* const);
+	int (*__eq_fn)(const void* const, const void* const);
+	void (*__init_fn)(void*);
+	void (*__acc_fn)(void*, const void*);
+
+	size_t nthreads;
+	char is_key_ptr;
+	char is_value_ptr;
+
+	void (*defer_key_fn)(void*);
+	void (*defer_value_fn)(void*);
+	void (*print_key_fn)(const void* const);
+	void (*print_value_fn)(const void* const);
+};
 
 #ifndef CYX_HASHMAP_BASE_SIZE
 #define CYX_HASHMAP_BASE_SIZE 32
@@ -1264,9 +4470,12 @@ void __cyx_hashmap_add(void** map_ptr, void* key);
 void __cyx_hashmap_add_v(void** map_ptr, void* key, void* val);
 void* __cyx_hashmap_get(struct __CyxHashMapFuncParams params);
 void* __cyx_hashmap_remove(struct __CyxHashMapFuncParams params);
+void* __cyx_hashmap_get_or_add(void** map_ptr, void* key, char* added);
 void cyx_hashmap_free(void* map);
 void cyx_hashmap_print(const void* map);
 
+void* __cyx_array_group_by(struct __CyxGroupByParams params);
+
 #define cyx_hashmap_size(map) (__CYX_HASHMAP_GET_HEADER(map)->len)
 #define cyx_hashmap_foreach(val, map) size_t __CYX_UNIQUE_VAL__(i) = 0; \
 	for (typeof(map->value)* val = (void*)((char*)map + __CYX_HASHMAP_GET_HEADER(map)->size_key); \
@@ -1298,6 +4507,14 @@ void cyx_hashmap_print(const void* map);
 	(typeof((map)->value)*)__cyx_hashmap_remove_params( .__map = map, .__key = &key, __VA_ARGS__ ); \
 })
 
+// builds a hashmap of `T` from `arr` in one pass: `key_fn(key, elem)` extracts the key, a new value is set up
+// with `init_fn(value)` (zeroed if NULL) and every element is folded into it with `acc_fn(value, elem)`,
+// `.nthreads` > 1 partitions the keys by hash and aggregates every partition on its own thread
+#define __cyx_array_group_by_params(...) __cyx_array_group_by((struct __CyxGroupByParams){ 0, __VA_ARGS__ })
+#define cyx_array_group_by(T, arr, key_fn, hash, eq, init_fn, acc_fn, ...) (T*)__cyx_array_group_by_params( \
+	.__arr = (arr), .__size_key = sizeof((T){0}.key), .__size_value = sizeof((T){0}.value), \
+	.__key_fn = key_fn, .__hash_fn = hash, .__eq_fn = eq, .__init_fn = init_fn, .__acc_fn = acc_fn, __VA_ARGS__)
+
 #ifdef CYLIBX_STRIP_PREFIX
 
 #define hashmap_size(map) cyx_hashmap_size(map)
@@ -1308,6 +4525,7 @@ void cyx_hashmap_print(const void* map);
 #define hashmap_add_v(map, k, v) cyx_hashmap_add_v(map, k, v)
 #define hashmap_get(map, k, ...) cyx_hashmap_get(map, k, __VA_ARGS__)
 #define hashmap_remove(map, k, ...) cyx_hashmap_remove(map, k, __VA_ARGS__)
+#define array_group_by(T, arr, key_fn, hash, eq, init_fn, acc_fn, ...) cyx_array_group_by(T, arr, key_fn, hash, eq, init_fn, acc_fn, __VA_ARGS__)
 
 #define hashmap_free cyx_hashmap_free
 #define hashmap_print cyx_hashmap_print
@@ -1368,11 +4586,11 @@ void __cyx_hashmap_expand(void** map_ptr) {
 		void* key = (char*)map + i * head->size;
 		size_t pos = head->hash_fn(!head->is_key_ptr ? key : *(void**)key) % new_head->cap;
 		for (size_t j = 0; j < new_head->cap; ++j) {
-			size_t probe = (pos + j * j) % new_head->cap;
+			size_t probe = (pos + j * (j + 1) / 2) % new_head->cap;
 			if (!cyx_bitmap_get(new_bitmap, 2 * probe)) {
 				memcpy((char*)new_map + probe * head->size, key, head->size);
 				cyx_bitmap_set(new_bitmap, 2 * probe, 1);
-				++head->len;
+				++new_head->len;
 				break;
 			} else if (cyx_bitmap_get(new_bitmap, 2 * probe + 1)) {
 				memcpy((char*)new_map + probe * head->size, key, head->size);
@@ -1400,7 +4618,7 @@ void __cyx_hashmap_add(void** map_ptr, void* key) {
 	size_t* bitmap = __CYX_HASHMAP_GET_BITMAP(map);
 	size_t pos = head->hash_fn(!head->is_key_ptr ? key : *(void**)key) % head->cap;
 	for (size_t i = 0; i < head->cap; ++i) {
-		size_t probe = (pos + i * i) % head->cap;
+		size_t probe = (pos + i * (i + 1) / 2) % head->cap;
 		if (!cyx_bitmap_get(bitmap, 2 * probe)) {
 			memcpy((char*)map + probe * head->size, key, head->size_key);
 			cyx_bitmap_set(bitmap, 2 * probe, 1);
@@ -1430,7 +4648,7 @@ void __cyx_hashmap_add_v(void** map_ptr, void* key, void* val) {
 	size_t* bitmap = __CYX_HASHMAP_GET_BITMAP(map);
 	size_t pos = head->hash_fn(!head->is_key_ptr ? key : *(void**)key) % head->cap;
 	for (size_t i = 0; i < head->cap; ++i) {
-		size_t probe = (pos + i * i) % head->cap;
+		size_t probe = (pos + i * (i + 1) / 2) % head->cap;
 		if (!cyx_bitmap_get(bitmap, 2 * probe)) {
 			memcpy((char*)map + probe * head->size, key, head->size_key);
 			memcpy((char*)map + probe * head->size + head->size_key, val, head->size_value);
@@ -1460,15 +4678,14 @@ void* __cyx_hashmap_get(struct __CyxHashMapFuncParams params) {
 
 	void* res = NULL;
 	for (size_t i = 0; i < head->cap; ++i) {
-		size_t probe = (pos + i * i) % head->cap;
-		if (cyx_bitmap_get(bitmap, 2 * probe) && !cyx_bitmap_get(bitmap, 2 * probe + 1)) {
+		size_t probe = (pos + i * (i + 1) / 2) % head->cap;
+		if (!cyx_bitmap_get(bitmap, 2 * probe)) { break; }
+		if (!cyx_bitmap_get(bitmap, 2 * probe + 1)) {
 			if (!head->is_key_ptr ?
 				 head->eq_fn((char*)params.__map + probe * head->size, params.__key) :
 				 head->eq_fn(*(void**)((char*)params.__map + probe * head->size), *(void**)params.__key)) {
 				res = (char*)params.__map + probe * head->size + head->size_key;
 				break;
-			} else {
-				break;
 			}
 		}
 	}
@@ -1487,15 +4704,14 @@ void* __cyx_hashmap_remove(struct __CyxHashMapFuncParams params) {
 
 	int res = -1;
 	for (size_t i = 0; i < head->cap; ++i) {
-		size_t probe = (pos + i * i) % head->cap;
-		if (cyx_bitmap_get(bitmap, 2 * probe) && !cyx_bitmap_get(bitmap, 2 * probe + 1)) {
+		size_t probe = (pos + i * (i + 1) / 2) % head->cap;
+		if (!cyx_bitmap_get(bitmap, 2 * probe)) { break; }
+		if (!cyx_bitmap_get(bitmap, 2 * probe + 1)) {
 			if (!head->is_key_ptr ?
 				 head->eq_fn((char*)params.__map + probe * head->size, params.__key) :
 				 head->eq_fn(*(void**)((char*)params.__map + probe * head->size), *(void**)params.__key)) {
 				res = (int)probe;
 				break;
-			} else {
-				break;
 			}
 		}
 	}
@@ -1519,6 +4735,43 @@ void* __cyx_hashmap_remove(struct __CyxHashMapFuncParams params) {
 	}
 	return removed;
 }
+void* __cyx_hashmap_get_or_add(void** map_ptr, void* key, char* added) {
+	void* map = *map_ptr;
+	__CyxHashMapHeader* head = __CYX_HASHMAP_GET_HEADER(map);
+	if (head->len * 1000 >= head->cap * 650) {
+		__cyx_hashmap_expand(map_ptr);
+		map = *map_ptr;
+		head = __CYX_HASHMAP_GET_HEADER(map);
+	}
+
+	assert(head->hash_fn && head->eq_fn);
+
+	size_t* bitmap = __CYX_HASHMAP_GET_BITMAP(map);
+	size_t pos = head->hash_fn(!head->is_key_ptr ? key : *(void**)key) % head->cap;
+	size_t free_slot = head->cap;
+	for (size_t i = 0; i < head->cap; ++i) {
+		size_t probe = (pos + i * (i + 1) / 2) % head->cap;
+		if (!cyx_bitmap_get(bitmap, 2 * probe)) {
+			if (free_slot == head->cap) { free_slot = probe; }
+			break;
+		} else if (cyx_bitmap_get(bitmap, 2 * probe + 1)) {
+			if (free_slot == head->cap) { free_slot = probe; }
+		} else if (!head->is_key_ptr ? head->eq_fn((char*)map + probe * head->size, key) : head->eq_fn(*(void**)((char*)map + probe * head->size), *(void**)key)) {
+			*added = 0;
+			return (char*)map + probe * head->size + head->size_key;
+		}
+	}
+	assert(free_slot != head->cap && "ERROR: No free slot left in the hashmap!");
+
+	void* entry = (char*)map + free_slot * head->size;
+	memcpy(entry, key, head->size_key);
+	memset((char*)entry + head->size_key, 0, head->size_value);
+	cyx_bitmap_set(bitmap, 2 * free_slot, 1);
+	cyx_bitmap_set(bitmap, 2 * free_slot + 1, 0);
+	++head->len;
+	*added = 1;
+	return (char*)entry + head->size_key;
+}
 void cyx_hashmap_free(void* map) {
 	assert(map);
 	
@@ -1580,6 +4833,418 @@ void cyx_hashmap_print(const void* map) {
 	printf(" }");
 }
 
+// rows are bucketed by partition like a radix sort pass: every chunk counts its rows per partition,
+// a prefix sum turns the counts into write offsets and the row indexes are scattered into `rows`
+struct __CyxGroupByCtx {
+	struct __CyxGroupByParams* params;
+	unsigned char* parts;
+	char* keys;
+	size_t* counts;
+	size_t* rows;
+	size_t* bounds;
+	void** maps;
+	size_t nparts;
+};
+
+#define __cyx_group_by_part(hash, count) ((size_t)((((hash) * 0x9E3779B97F4A7C15ull) >> 32) % (count)))
+
+static void* __cyx_group_by_new_map(struct __CyxGroupByParams* params) {
+	return __cyx_hashmap_new((struct __CyxHashMapParams){
+		.__size_key = params->__size_key,
+		.__size_value = params->__size_value,
+		.is_key_ptr = params->is_key_ptr,
+		.is_value_ptr = params->is_value_ptr,
+		.__hash_fn = params->__hash_fn,
+		.__eq_fn = params->__eq_fn,
+		.defer_key_fn = params->defer_key_fn,
+		.defer_value_fn = params->defer_value_fn,
+		.print_key_fn = params->print_key_fn,
+		.print_value_fn = params->print_value_fn,
+	});
+}
+static void __cyx_group_by_add(void** map_ptr, struct __CyxGroupByParams* params, void* key, const void* elem) {
+	char added;
+	void* value = __cyx_hashmap_get_or_add(map_ptr, key, &added);
+	if (added) {
+		if (params->__init_fn) { params->__init_fn(value); }
+	} else if (params->defer_key_fn) {
+		params->defer_key_fn(!params->is_key_ptr ? key : *(void**)key);
+	}
+	params->__acc_fn(value, elem);
+}
+static void __cyx_group_by_partition(struct __CyxThreadTask* task) {
+	struct __CyxGroupByCtx* ctx = task->ctx;
+	struct __CyxGroupByParams* params = ctx->params;
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(params->__arr);
+
+	// the keys are kept for the aggregation, so `key_fn` runs once per row
+	size_t* counts = ctx->counts + task->id * ctx->nparts;
+	for (size_t i = task->start; i < task->end; ++i) {
+		void* key = ctx->keys + i * params->__size_key;
+		params->__key_fn(key, __CYX_DATA_GET_AT(head, params->__arr, i));
+		size_t hash = params->__hash_fn(!params->is_key_ptr ? key : *(void**)key);
+		ctx->parts[i] = __cyx_group_by_part(hash, ctx->nparts);
+		++counts[ctx->parts[i]];
+	}
+}
+static void __cyx_group_by_scatter(struct __CyxThreadTask* task) {
+	struct __CyxGroupByCtx* ctx = task->ctx;
+	size_t* offsets = ctx->counts + task->id * ctx->nparts;
+	for (size_t i = task->start; i < task->end; ++i) { ctx->rows[offsets[ctx->parts[i]]++] = i; }
+}
+static void __cyx_group_by_aggregate(struct __CyxThreadTask* task) {
+	struct __CyxGroupByCtx* ctx = task->ctx;
+	struct __CyxGroupByParams* params = ctx->params;
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(params->__arr);
+
+	void* map = __cyx_group_by_new_map(params);
+	for (size_t k = ctx->bounds[task->id]; k < ctx->bounds[task->id + 1]; ++k) {
+		size_t i = ctx->rows[k];
+		__cyx_group_by_add(&map, params, ctx->keys + i * params->__size_key, __CYX_DATA_GET_AT(head, params->__arr, i));
+	}
+	ctx->maps[task->id] = map;
+}
+void* __cyx_array_group_by(struct __CyxGroupByParams params) {
+	assert(params.__arr);
+	assert(params.__key_fn && params.__hash_fn && params.__eq_fn && params.__acc_fn);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(params.__arr);
+
+	void* map = __cyx_group_by_new_map(&params);
+	size_t nthreads = params.nthreads > 1 ? __cyx_thread_count(params.nthreads, head->len) : 1;
+	if (nthreads > UCHAR_MAX + 1) { nthreads = UCHAR_MAX + 1; }
+
+	if (nthreads <= 1) {
+		void* key = malloc(params.__size_key);
+		assert(key);
+		for (size_t i = 0; i < head->len; ++i) {
+			const void* elem = __CYX_DATA_GET_AT(head, params.__arr, i);
+			params.__key_fn(key, elem);
+			__cyx_group_by_add(&map, &params, key, elem);
+		}
+		free(key);
+		return map;
+	}
+
+	struct __CyxGroupByCtx ctx = {
+		.params = &params,
+		.parts = malloc(head->len),
+		.keys = malloc(head->len * params.__size_key),
+		.counts = calloc(nthreads * nthreads, sizeof(size_t)),
+		.rows = malloc(head->len * sizeof(size_t)),
+		.bounds = malloc((nthreads + 1) * sizeof(size_t)),
+		.maps = malloc(nthreads * sizeof(void*)),
+		.nparts = nthreads,
+	};
+	assert(ctx.parts && ctx.keys && ctx.counts && ctx.rows && ctx.bounds && ctx.maps);
+
+	// both passes split the rows the same way, so chunk `t` scatters exactly the rows it counted
+	__cyx_parallel_run(nthreads, head->len, __cyx_group_by_partition, &ctx);
+	size_t offset = 0;
+	for (size_t p = 0; p < nthreads; ++p) {
+		ctx.bounds[p] = offset;
+		for (size_t t = 0; t < nthreads; ++t) {
+			size_t count = ctx.counts[t * nthreads + p];
+			ctx.counts[t * nthreads + p] = offset;
+			offset += count;
+		}
+	}
+	ctx.bounds[nthreads] = offset;
+	__cyx_parallel_run(nthreads, head->len, __cyx_group_by_scatter, &ctx);
+	// every partition is aggregated by exactly one thread, so the partial maps have disjoint keys
+	__cyx_parallel_run(nthreads, nthreads, __cyx_group_by_aggregate, &ctx);
+
+	for (size_t t = 0; t < nthreads; ++t) {
+		void* part = ctx.maps[t];
+		__CyxHashMapHeader* part_head = __CYX_HASHMAP_GET_HEADER(part);
+		size_t* bitmap = __CYX_HASHMAP_GET_BITMAP(part);
+		for (size_t i = 0; i < part_head->cap; ++i) {
+			if (!cyx_bitmap_get(bitmap, 2 * i) || cyx_bitmap_get(bitmap, 2 * i + 1)) { continue; }
+			void* entry = (char*)part + i * part_head->size;
+			__cyx_hashmap_add_v(&map, entry, (char*)entry + part_head->size_key);
+		}
+		free(part_head);
+	}
+
+	free(ctx.parts);
+	free(ctx.keys);
+	free(ctx.counts);
+	free(ctx.rows);
+	free(ctx.bounds);
+	free(ctx.maps);
+	return map;
+}
+
+#undef __cyx_group_by_part
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
+/*
+ * CuckooFilter
+ */
+
+#if __CYX_CLOSE_FOLD
+
+typedef struct {
+	size_t len;
+	size_t cap;
+	size_t size;
+
+	size_t fp_bits;
+	size_t fp_size;
+	size_t max_kicks;
+	size_t seed;
+
+	char is_ptr;
+	char has_victim;
+	size_t victim_pos;
+	size_t victim_fp;
+
+	size_t (*hash_fn)(const void* const);
+	void (*defer_fn)(void*);
+} __CyxCuckooHeader;
+
+struct __CyxCuckooParams {
+	size_t __size;
+	size_t reserve;
+	size_t max_kicks;
+	double fp_rate;
+	char is_ptr;
+
+	size_t (*__hash_fn)(const void* const);
+	void (*defer_fn)(void*);
+};
+struct __CyxCuckooFuncParams {
+	void* __filter;
+	void* __val;
+	char defer;
+};
+
+#ifndef CYX_CUCKOO_BASE_SIZE
+#define CYX_CUCKOO_BASE_SIZE 1024
+#endif // CYX_CUCKOO_BASE_SIZE
+#ifndef CYX_CUCKOO_FP_RATE
+#define CYX_CUCKOO_FP_RATE 0.01
+#endif // CYX_CUCKOO_FP_RATE
+#ifndef CYX_CUCKOO_MAX_KICKS
+#define CYX_CUCKOO_MAX_KICKS 500
+#endif // CYX_CUCKOO_MAX_KICKS
+#define __CYX_CUCKOO_BUCKET_SLOTS 4
+
+#define __CYX_CUCKOO_HEADER_SIZE (sizeof(__CyxCuckooHeader))
+#define __CYX_CUCKOO_GET_HEADER(filter) ((__CyxCuckooHeader*)(filter) - 1)
+
+void* __cyx_cuckoo_new(struct __CyxCuckooParams params);
+int __cyx_cuckoo_add(struct __CyxCuckooFuncParams params);
+int __cyx_cuckoo_contains(struct __CyxCuckooFuncParams params);
+int __cyx_cuckoo_remove(struct __CyxCuckooFuncParams params);
+void cyx_cuckoo_free(void* filter);
+
+// only fingerprints are stored: contains can give false positives (`.fp_rate`), removing a value that was never added is undefined
+#define cyx_cuckoo_length(filter) (__CYX_CUCKOO_GET_HEADER(filter)->len)
+#define cyx_cuckoo_memory(filter) (__CYX_CUCKOO_HEADER_SIZE + __CYX_CUCKOO_GET_HEADER(filter)->cap * __CYX_CUCKOO_BUCKET_SLOTS * __CYX_CUCKOO_GET_HEADER(filter)->fp_size)
+
+#define __cyx_cuckoo_new_params(...) __cyx_cuckoo_new((struct __CyxCuckooParams){ 0, __VA_ARGS__ })
+#define cyx_cuckoo_new(T, hash, ...) (T*)__cyx_cuckoo_new_params(.__size = sizeof(T), .__hash_fn = hash, __VA_ARGS__)
+#define __cyx_cuckoo_add_params(...) __cyx_cuckoo_add((struct __CyxCuckooFuncParams){ 0, __VA_ARGS__ })
+#define cyx_cuckoo_add(filter, val, ...) ({ \
+	typeof(*filter) v = (val); \
+	__cyx_cuckoo_add_params(.__filter = (filter), .__val = &v, __VA_ARGS__); \
+})
+#define __cyx_cuckoo_contains_params(...) __cyx_cuckoo_contains((struct __CyxCuckooFuncParams){ 0, __VA_ARGS__ })
+#define cyx_cuckoo_contains(filter, val, ...) ({ \
+	typeof(*filter) v = (val); \
+	__cyx_cuckoo_contains_params(.__filter = (filter), .__val = &v, __VA_ARGS__); \
+})
+#define __cyx_cuckoo_remove_params(...) __cyx_cuckoo_remove((struct __CyxCuckooFuncParams){ 0, __VA_ARGS__ })
+#define cyx_cuckoo_remove(filter, val, ...) ({ \
+	typeof(*filter) v = (val); \
+	__cyx_cuckoo_remove_params(.__filter = (filter), .__val = &v, __VA_ARGS__); \
+})
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define cuckoo_length(filter) cyx_cuckoo_length(filter)
+#define cuckoo_memory(filter) cyx_cuckoo_memory(filter)
+
+#define cuckoo_new(T, hash, ...) cyx_cuckoo_new(T, hash, __VA_ARGS__)
+#define cuckoo_add(filter, val, ...) cyx_cuckoo_add(filter, val, __VA_ARGS__)
+#define cuckoo_contains(filter, val, ...) cyx_cuckoo_contains(filter, val, __VA_ARGS__)
+#define cuckoo_remove(filter, val, ...) cyx_cuckoo_remove(filter, val, __VA_ARGS__)
+
+#define cuckoo_free cyx_cuckoo_free
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+#define __cyx_cuckoo_slot(head, filter, bucket, slot) ((char*)(filter) + ((bucket) * __CYX_CUCKOO_BUCKET_SLOTS + (slot)) * (head)->fp_size)
+#define __cyx_cuckoo_alt_pos(head, pos, fp) ({ \
+	size_t __fp = (fp); \
+	((pos) ^ cyx_hash_size_t(&__fp)) & ((head)->cap - 1); \
+})
+
+static inline size_t __cyx_cuckoo_fp_get(__CyxCuckooHeader* head, void* filter, size_t bucket, size_t slot) {
+	void* p = __cyx_cuckoo_slot(head, filter, bucket, slot);
+	return head->fp_size == 1 ? *(unsigned char*)p : *(unsigned short*)p;
+}
+static inline void __cyx_cuckoo_fp_set(__CyxCuckooHeader* head, void* filter, size_t bucket, size_t slot, size_t fp) {
+	void* p = __cyx_cuckoo_slot(head, filter, bucket, slot);
+	if (head->fp_size == 1) { *(unsigned char*)p = (unsigned char)fp; } else { *(unsigned short*)p = (unsigned short)fp; }
+}
+static inline void __cyx_cuckoo_locate(__CyxCuckooHeader* head, void* val, size_t* pos, size_t* fp) {
+	size_t hash = head->hash_fn(!head->is_ptr ? val : *(void**)val);
+	hash = cyx_hash_size_t(&hash);
+	*pos = hash & (head->cap - 1);
+	*fp = (hash >> 32) & ((1ull << head->fp_bits) - 1);
+	if (!*fp) { *fp = 1; }
+}
+static int __cyx_cuckoo_bucket_insert(__CyxCuckooHeader* head, void* filter, size_t bucket, size_t fp) {
+	for (size_t i = 0; i < __CYX_CUCKOO_BUCKET_SLOTS; ++i) {
+		if (!__cyx_cuckoo_fp_get(head, filter, bucket, i)) {
+			__cyx_cuckoo_fp_set(head, filter, bucket, i, fp);
+			return 1;
+		}
+	}
+	return 0;
+}
+static int __cyx_cuckoo_bucket_has(__CyxCuckooHeader* head, void* filter, size_t bucket, size_t fp) {
+	for (size_t i = 0; i < __CYX_CUCKOO_BUCKET_SLOTS; ++i) {
+		if (__cyx_cuckoo_fp_get(head, filter, bucket, i) == fp) { return 1; }
+	}
+	return 0;
+}
+static int __cyx_cuckoo_bucket_delete(__CyxCuckooHeader* head, void* filter, size_t bucket, size_t fp) {
+	for (size_t i = 0; i < __CYX_CUCKOO_BUCKET_SLOTS; ++i) {
+		if (__cyx_cuckoo_fp_get(head, filter, bucket, i) == fp) {
+			__cyx_cuckoo_fp_set(head, filter, bucket, i, 0);
+			return 1;
+		}
+	}
+	return 0;
+}
+static void __cyx_cuckoo_place(__CyxCuckooHeader* head, void* filter, size_t pos, size_t fp) {
+	if (__cyx_cuckoo_bucket_insert(head, filter, pos, fp)) { return; }
+	pos = __cyx_cuckoo_alt_pos(head, pos, fp);
+	if (__cyx_cuckoo_bucket_insert(head, filter, pos, fp)) { return; }
+
+	for (size_t kick = 0; kick < head->max_kicks; ++kick) {
+		head->seed = head->seed * 6364136223846793005ull + 1442695040888963407ull;
+		size_t slot = (head->seed >> 33) % __CYX_CUCKOO_BUCKET_SLOTS;
+		size_t kicked = __cyx_cuckoo_fp_get(head, filter, pos, slot);
+		__cyx_cuckoo_fp_set(head, filter, pos, slot, fp);
+		fp = kicked;
+		pos = __cyx_cuckoo_alt_pos(head, pos, fp);
+		if (__cyx_cuckoo_bucket_insert(head, filter, pos, fp)) { return; }
+	}
+
+	head->has_victim = 1;
+	head->victim_pos = pos;
+	head->victim_fp = fp;
+}
+
+void* __cyx_cuckoo_new(struct __CyxCuckooParams params) {
+	size_t reserve = params.reserve ? params.reserve : CYX_CUCKOO_BASE_SIZE;
+	double fp_rate = params.fp_rate > 0.0 ? params.fp_rate : CYX_CUCKOO_FP_RATE;
+
+	// false positive rate is bound by 2 * slots / 2^fp_bits
+	size_t fp_bits = 4;
+	while (fp_bits < 16 && 2.0 * __CYX_CUCKOO_BUCKET_SLOTS / (double)(1ull << fp_bits) > fp_rate) { ++fp_bits; }
+	size_t fp_size = fp_bits <= 8 ? 1 : 2;
+
+	// buckets are kept at 95% load at most
+	size_t cap = 2;
+	while (cap * __CYX_CUCKOO_BUCKET_SLOTS * 95 < reserve * 100) { cap <<= 1; }
+
+	size_t to_alloc = __CYX_CUCKOO_HEADER_SIZE + cap * __CYX_CUCKOO_BUCKET_SLOTS * fp_size;
+	__CyxCuckooHeader* head = malloc(to_alloc);
+	if (!head) { return NULL; }
+	memset(head, 0, to_alloc);
+
+	head->cap = cap;
+	head->size = params.__size;
+	head->fp_bits = fp_bits;
+	head->fp_size = fp_size;
+	head->max_kicks = params.max_kicks ? params.max_kicks : CYX_CUCKOO_MAX_KICKS;
+	head->seed = (size_t)head;
+	head->is_ptr = params.is_ptr;
+	head->hash_fn = params.__hash_fn;
+	head->defer_fn = params.defer_fn;
+
+	return head + 1;
+}
+int __cyx_cuckoo_add(struct __CyxCuckooFuncParams params) {
+	assert(params.__filter);
+	__CyxCuckooHeader* head = __CYX_CUCKOO_GET_HEADER(params.__filter);
+	assert(head->hash_fn && "ERROR: No hash function provided to cuckoo filter!");
+
+	int res = 0;
+	if (!head->has_victim) {
+		size_t pos, fp;
+		__cyx_cuckoo_locate(head, params.__val, &pos, &fp);
+		__cyx_cuckoo_place(head, params.__filter, pos, fp);
+		++head->len;
+		res = 1;
+	}
+	if (params.defer && head->defer_fn) {
+		head->defer_fn(!head->is_ptr ? params.__val : *(void**)params.__val);
+	}
+	return res;
+}
+int __cyx_cuckoo_contains(struct __CyxCuckooFuncParams params) {
+	assert(params.__filter);
+	__CyxCuckooHeader* head = __CYX_CUCKOO_GET_HEADER(params.__filter);
+	assert(head->hash_fn && "ERROR: No hash function provided to cuckoo filter!");
+
+	size_t pos, fp;
+	__cyx_cuckoo_locate(head, params.__val, &pos, &fp);
+	size_t alt_pos = __cyx_cuckoo_alt_pos(head, pos, fp);
+
+	int res = __cyx_cuckoo_bucket_has(head, params.__filter, pos, fp) ||
+		__cyx_cuckoo_bucket_has(head, params.__filter, alt_pos, fp) ||
+		(head->has_victim && head->victim_fp == fp && (head->victim_pos == pos || head->victim_pos == alt_pos));
+
+	if (params.defer && head->defer_fn) {
+		head->defer_fn(!head->is_ptr ? params.__val : *(void**)params.__val);
+	}
+	return res;
+}
+int __cyx_cuckoo_remove(struct __CyxCuckooFuncParams params) {
+	assert(params.__filter);
+	__CyxCuckooHeader* head = __CYX_CUCKOO_GET_HEADER(params.__filter);
+	assert(head->hash_fn && "ERROR: No hash function provided to cuckoo filter!");
+
+	size_t pos, fp;
+	__cyx_cuckoo_locate(head, params.__val, &pos, &fp);
+	size_t alt_pos = __cyx_cuckoo_alt_pos(head, pos, fp);
+
+	int res = 0;
+	if (head->has_victim && head->victim_fp == fp && (head->victim_pos == pos || head->victim_pos == alt_pos)) {
+		head->has_victim = 0;
+		res = 1;
+	} else if (__cyx_cuckoo_bucket_delete(head, params.__filter, pos, fp) || __cyx_cuckoo_bucket_delete(head, params.__filter, alt_pos, fp)) {
+		res = 1;
+		if (head->has_victim) {
+			head->has_victim = 0;
+			__cyx_cuckoo_place(head, params.__filter, head->victim_pos, head->victim_fp);
+		}
+	}
+	if (res) { --head->len; }
+
+	if (params.defer && head->defer_fn) {
+		head->defer_fn(!head->is_ptr ? params.__val : *(void**)params.__val);
+	}
+	return res;
+}
+void cyx_cuckoo_free(void* filter) {
+	assert(filter);
+	free(__CYX_CUCKOO_GET_HEADER(filter));
+}
+
+#undef __cyx_cuckoo_slot
+#undef __cyx_cuckoo_alt_pos
+
 #endif // CYLIBX_IMPLEMENTATION
 
 #endif // __CYX_CLOSE_FOLD
@@ -1596,6 +5261,8 @@ typedef struct {
 	size_t size;
 
 	char is_ptr;
+	char is_mmap;
+	char huge_pages;
 
 	int (*cmp_fn)(const void*, const void*);
 	void (*defer_fn)(void*);
@@ -1606,6 +5273,7 @@ struct __CyxBinaryHeapParams {
 	size_t __size;
 
 	char is_ptr;
+	char huge_pages;
 
 	int (*__cmp_fn)(const void*, const void*);
 	void (*defer_fn)(void*);
@@ -1686,7 +5354,8 @@ void cyx_binheap_print(const void* heap);
 #define __cyx_get_parent(n) (((n) - 1) >> 1)
 
 void* __cyx_binheap_new(struct __CyxBinaryHeapParams params) {
-	__CyxBinaryHeapHeader* head = malloc(__CYX_BINHEAP_HEADER_SIZE + params.__size * CYX_BINHEAP_BASE_SIZE);
+	char is_mmap;
+	__CyxBinaryHeapHeader* head = __cyx_mem_alloc(__CYX_BINHEAP_HEADER_SIZE + params.__size * CYX_BINHEAP_BASE_SIZE, params.huge_pages, &is_mmap);
 	assert(head);
 	void* heap = head + 1;
 
@@ -1694,6 +5363,8 @@ void* __cyx_binheap_new(struct __CyxBinaryHeapParams params) {
 	head->cap = CYX_BINHEAP_BASE_SIZE;
 	head->size = params.__size;
 	head->is_ptr = params.is_ptr;
+	head->is_mmap = is_mmap;
+	head->huge_pages = params.huge_pages;
 
 	head->cmp_fn = params.__cmp_fn;
 	head->defer_fn = params.defer_fn;
@@ -1707,20 +5378,17 @@ void __cyx_binheap_expand(void** heap_ptr, size_t n) {
 	size_t new_cap = head->cap;
 	while (new_cap < head->len + n) { new_cap <<= 1; }
 
-	__CyxBinaryHeapHeader* new_head = malloc(__CYX_BINHEAP_HEADER_SIZE + new_cap * head->size);
-	new_head->len = head->len;
+	char is_mmap = head->is_mmap;
+	__CyxBinaryHeapHeader* new_head = __cyx_mem_realloc(head,
+		__CYX_BINHEAP_HEADER_SIZE + head->cap * head->size,
+		__CYX_BINHEAP_HEADER_SIZE + head->len * head->size,
+		__CYX_BINHEAP_HEADER_SIZE + new_cap * head->size,
+		head->huge_pages, &is_mmap);
+	assert(new_head && "ERROR: Could not grow the heap!");
 	new_head->cap = new_cap;
-	new_head->size = head->size;
-	new_head->is_ptr = head->is_ptr;
-
-	new_head->cmp_fn = head->cmp_fn;
-	new_head->defer_fn = head->defer_fn;
-	new_head->print_fn = head->print_fn;
+	new_head->is_mmap = is_mmap;
 
-	void* new_heap = new_head + 1;
-	memcpy(new_heap, heap, head->cap * head->size);
-	free(head);
-	*heap_ptr = new_heap;
+	*heap_ptr = new_head + 1;
 }
 void __cyx_binheap_insert(void** heap_ptr, void* val) {
 	void* heap = *heap_ptr;
@@ -1848,8 +5516,7 @@ void cyx_binheap_free(void* heap) {
 		}
 	}
 
-
-	free(head);
+	__cyx_mem_free(head, __CYX_BINHEAP_HEADER_SIZE + head->cap * head->size, head->is_mmap);
 }
 void cyx_binheap_print(const void* heap) {
 	assert(heap);
@@ -1901,6 +5568,8 @@ typedef struct {
 	size_t end;
 
 	char is_ptr;
+	char is_mmap;
+	char huge_pages;
 
 	void (*defer_fn)(void*);
 	void (*print_fn)(const void*);
@@ -1910,6 +5579,7 @@ struct __CyxRingBufParams {
 	size_t __size;
 
 	char is_ptr;
+	char huge_pages;
 	void (*defer_fn)(void*);
 	void (*print_fn)(const void*);
 };
@@ -1974,8 +5644,12 @@ void cyx_ring_print(const void* ring);
 #ifdef CYLIBX_IMPLEMENTATION 
 
 void* __cyx_ring_new(struct __CyxRingBufParams params) {
-	__CyxRingBufHeader* head = malloc(__CYX_RINGBUF_HEADER_SIZE + params.__size * CYX_RINGBUF_BASE_SIZE);
+	char is_mmap;
+	__CyxRingBufHeader* head = __cyx_mem_alloc(__CYX_RINGBUF_HEADER_SIZE + params.__size * CYX_RINGBUF_BASE_SIZE, params.huge_pages, &is_mmap);
+	assert(head);
 	memset(head, 0, __CYX_RINGBUF_HEADER_SIZE + params.__size * CYX_RINGBUF_BASE_SIZE);
+	head->is_mmap = is_mmap;
+	head->huge_pages = params.huge_pages;
 	head->size = params.__size;
 	head->cap = CYX_RINGBUF_BASE_SIZE;
 	head->len = 0;
@@ -1995,20 +5669,24 @@ void __cyx_ring_expand(void** ring_ptr, size_t n) {
 	size_t new_cap = head->cap;
 	while ((new_cap <<= 1) <= head->len + n);
 
-	__CyxRingBufHeader* new_head = malloc(__CYX_RINGBUF_HEADER_SIZE + new_cap * head->size);
+	size_t old_cap = head->cap;
+	char is_mmap = head->is_mmap;
+	__CyxRingBufHeader* new_head = __cyx_mem_realloc(head,
+		__CYX_RINGBUF_HEADER_SIZE + old_cap * head->size,
+		__CYX_RINGBUF_HEADER_SIZE + old_cap * head->size,
+		__CYX_RINGBUF_HEADER_SIZE + new_cap * head->size,
+		head->huge_pages, &is_mmap);
+	assert(new_head && "ERROR: Could not grow the ring buffer!");
 	void* new_ring = new_head + 1;
-	memcpy(new_head, head, __CYX_RINGBUF_HEADER_SIZE);
 	new_head->cap = new_cap;
-	new_head->start = 0;
-	new_head->end = 0;
+	new_head->is_mmap = is_mmap;
 
-	cyx_ring_foreach(val, *ring_ptr) {
-		memcpy(__CYX_DATA_GET_AT(new_head, new_ring, new_head->len), val, head->size);
-		new_head->len++;
-		new_head->end++;
+	// the wrapped part [0, end) moves right after the old capacity so the elements stay contiguous
+	if (new_head->len && new_head->end <= new_head->start) {
+		memcpy(__CYX_DATA_GET_AT(new_head, new_ring, old_cap), new_ring, new_head->end * new_head->size);
+		new_head->end += old_cap;
 	}
 
-	free(head);
 	*ring_ptr = new_ring;
 }
 void __cyx_ring_push(void** ring_ptr, void* val) {
@@ -2074,7 +5752,7 @@ void cyx_ring_free(void* ring) {
 			}
 		}
 	}
-	free(head);
+	__cyx_mem_free(head, __CYX_RINGBUF_HEADER_SIZE + head->cap * head->size, head->is_mmap);
 }
 void cyx_ring_print(const void* ring) {
 	assert(ring);
@@ -2093,4 +5771,252 @@ void cyx_ring_print(const void* ring) {
 
 #endif // __CYX_CLOSE_FOLD
 
+/*
+ * Iterator
+ */
+
+#if __CYX_CLOSE_FOLD
+
+#ifndef CYX_ITER_MAX_STAGES
+#define CYX_ITER_MAX_STAGES 8
+#endif // CYX_ITER_MAX_STAGES
+#ifndef CYX_ITER_ELEM_MAX
+#define CYX_ITER_ELEM_MAX 256
+#endif // CYX_ITER_ELEM_MAX
+
+typedef enum {
+	__CYX_ITER_SRC_ARRAY,
+	__CYX_ITER_SRC_RING,
+	__CYX_ITER_SRC_SLOTS,
+} __CyxIterSource;
+
+typedef enum {
+	__CYX_ITER_MAP,
+	__CYX_ITER_FILTER,
+	__CYX_ITER_TAKE,
+} __CyxIterStageKind;
+
+struct __CyxIterStage {
+	__CyxIterStageKind kind;
+	union {
+		void (*map_fn)(void*, const void*);
+		int (*filter_fn)(const void*);
+		size_t left;
+	};
+};
+
+// map buffers are padded so the second one stays aligned for any type
+#define __CYX_ITER_BUF_SIZE ((CYX_ITER_ELEM_MAX + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t))
+
+// a pipeline is a plain value, stages are appended by value and nothing runs until it is consumed,
+// every stage builder copies the whole struct (the map buffers make it ~750 bytes with the defaults),
+// so build pipelines once outside of hot loops
+typedef struct {
+	__CyxIterSource source;
+	char* base;
+	const size_t* bitmap;
+	size_t step;
+	size_t offset;
+	size_t cap;
+	size_t start;
+	size_t pos;
+	size_t end;
+	size_t hint;
+
+	size_t size;
+	char done;
+
+	size_t stage_count;
+	struct __CyxIterStage stages[CYX_ITER_MAX_STAGES];
+	_Alignas(max_align_t) char buf[2][__CYX_ITER_BUF_SIZE];
+} CyxIter;
+
+CyxIter cyx_iter_from_array(const void* arr);
+CyxIter cyx_iter_from_ring(const void* ring);
+CyxIter cyx_iter_from_hashset(const void* set);
+CyxIter cyx_iter_from_hashmap_keys(const void* map);
+CyxIter cyx_iter_from_hashmap_values(const void* map);
+CyxIter __cyx_iter_map(CyxIter it, size_t size, void (*fn)(void*, const void*));
+CyxIter cyx_iter_filter(CyxIter it, int (*fn)(const void*));
+CyxIter cyx_iter_take(CyxIter it, size_t n);
+void* cyx_iter_next(CyxIter* it);
+void* __cyx_iter_collect(CyxIter it, struct __CyxArrayParams params);
+void __cyx_iter_fold(CyxIter it, void* accumulator, void (*fn)(void*, const void*));
+
+// `fn` writes a `T` built from the current element into its first argument
+#define cyx_iter_map(it, T, fn) __cyx_iter_map(it, sizeof(T), fn)
+#define cyx_iter_collect(T, it, ...) (T*)__cyx_iter_collect(it, (struct __CyxArrayParams){ 0, .__size = sizeof(T), __VA_ARGS__ })
+#define cyx_iter_fold(T, it, accumulator, fn) ({ \
+	T acc = (accumulator); \
+	__cyx_iter_fold(it, &acc, fn); \
+	acc; \
+})
+#define cyx_iter_foreach(val, T, it) for (struct { CyxIter iter; T* value; } val = { .iter = (it) }; (val.value = cyx_iter_next(&val.iter));)
+
+#ifdef CYLIBX_STRIP_PREFIX
+
+#define iter_map(it, T, fn) cyx_iter_map(it, T, fn)
+#define iter_collect(T, it, ...) cyx_iter_collect(T, it, __VA_ARGS__)
+#define iter_fold(T, it, accumulator, fn) cyx_iter_fold(T, it, accumulator, fn)
+#define iter_foreach(val, T, it) cyx_iter_foreach(val, T, it)
+
+#define iter_from_array cyx_iter_from_array
+#define iter_from_ring cyx_iter_from_ring
+#define iter_from_hashset cyx_iter_from_hashset
+#define iter_from_hashmap_keys cyx_iter_from_hashmap_keys
+#define iter_from_hashmap_values cyx_iter_from_hashmap_values
+#define iter_filter cyx_iter_filter
+#define iter_take cyx_iter_take
+#define iter_next cyx_iter_next
+
+#endif // CYLIBX_STRIP_PREFIX
+
+#ifdef CYLIBX_IMPLEMENTATION
+
+CyxIter cyx_iter_from_array(const void* arr) {
+	assert(arr);
+	__CyxArrayHeader* head = __CYX_ARRAY_GET_HEADER(arr);
+	return (CyxIter){
+		.source = __CYX_ITER_SRC_ARRAY,
+		.base = (char*)arr,
+		.step = head->size,
+		.end = head->len,
+		.hint = head->len,
+		.size = head->size,
+	};
+}
+CyxIter cyx_iter_from_ring(const void* ring) {
+	assert(ring);
+	__CyxRingBufHeader* head = __CYX_RINGBUF_GET_HEADER(ring);
+	return (CyxIter){
+		.source = __CYX_ITER_SRC_RING,
+		.base = (char*)ring,
+		.step = head->size,
+		.cap = head->cap,
+		.start = head->start,
+		.end = head->len,
+		.hint = head->len,
+		.size = head->size,
+	};
+}
+CyxIter cyx_iter_from_hashset(const void* set) {
+	assert(set);
+	__CyxHashSetHeader* head = __CYX_HASH_SET_GET_HEADER(set);
+	return (CyxIter){
+		.source = __CYX_ITER_SRC_SLOTS,
+		.base = (char*)set,
+		.bitmap = __CYX_HASH_SET_GET_BITMAP(set),
+		.step = head->size,
+		.end = head->cap,
+		.hint = head->len,
+		.size = head->size,
+	};
+}
+CyxIter cyx_iter_from_hashmap_keys(const void* map) {
+	assert(map);
+	__CyxHashMapHeader* head = __CYX_HASHMAP_GET_HEADER(map);
+	return (CyxIter){
+		.source = __CYX_ITER_SRC_SLOTS,
+		.base = (char*)map,
+		.bitmap = __CYX_HASHMAP_GET_BITMAP(map),
+		.step = head->size,
+		.end = head->cap,
+		.hint = head->len,
+		.size = head->size_key,
+	};
+}
+CyxIter cyx_iter_from_hashmap_values(const void* map) {
+	CyxIter it = cyx_iter_from_hashmap_keys(map);
+	it.offset = __CYX_HASHMAP_GET_HEADER(map)->size_key;
+	it.size = __CYX_HASHMAP_GET_HEADER(map)->size_value;
+	return it;
+}
+static CyxIter __cyx_iter_push(CyxIter it, struct __CyxIterStage stage) {
+	assert(it.stage_count < CYX_ITER_MAX_STAGES && "ERROR: Too many iterator stages, raise CYX_ITER_MAX_STAGES!");
+	it.stages[it.stage_count++] = stage;
+	return it;
+}
+CyxIter __cyx_iter_map(CyxIter it, size_t size, void (*fn)(void*, const void*)) {
+	assert(size <= CYX_ITER_ELEM_MAX && "ERROR: Mapped element is too big, raise CYX_ITER_ELEM_MAX!");
+	it.size = size;
+	return __cyx_iter_push(it, (struct __CyxIterStage){ .kind = __CYX_ITER_MAP, .map_fn = fn });
+}
+CyxIter cyx_iter_filter(CyxIter it, int (*fn)(const void*)) {
+	return __cyx_iter_push(it, (struct __CyxIterStage){ .kind = __CYX_ITER_FILTER, .filter_fn = fn });
+}
+CyxIter cyx_iter_take(CyxIter it, size_t n) {
+	if (n < it.hint) { it.hint = n; }
+	if (!n) { it.done = 1; }
+	return __cyx_iter_push(it, (struct __CyxIterStage){ .kind = __CYX_ITER_TAKE, .left = n });
+}
+static void* __cyx_iter_source_next(CyxIter* it) {
+	switch (it->source) {
+	case __CYX_ITER_SRC_ARRAY:
+		if (it->pos == it->end) { return NULL; }
+		return it->base + it->pos++ * it->step;
+	case __CYX_ITER_SRC_RING:
+		if (it->pos == it->end) { return NULL; }
+		return it->base + (it->start + it->pos++) % it->cap * it->step;
+	case __CYX_ITER_SRC_SLOTS:
+		while (it->pos < it->end) {
+			size_t i = it->pos++;
+			if (cyx_bitmap_get(it->bitmap, 2 * i) && !cyx_bitmap_get(it->bitmap, 2 * i + 1)) {
+				return it->base + i * it->step + it->offset;
+			}
+		}
+		return NULL;
+	}
+	return NULL;
+}
+// the returned element lives until the next call
+void* cyx_iter_next(CyxIter* it) {
+	if (it->done) { return NULL; }
+
+	void* val;
+	while ((val = __cyx_iter_source_next(it))) {
+		char passed = 1;
+		size_t b = 0;
+		for (size_t i = 0; passed && i < it->stage_count; ++i) {
+			struct __CyxIterStage* stage = &it->stages[i];
+			switch (stage->kind) {
+			case __CYX_ITER_MAP:
+				stage->map_fn(it->buf[b], val);
+				val = it->buf[b];
+				b ^= 1;
+				break;
+			case __CYX_ITER_FILTER:
+				passed = stage->filter_fn(val) != 0;
+				break;
+			case __CYX_ITER_TAKE:
+				// the pipeline ends with the last taken element instead of pulling one more from the source
+				if (!--stage->left) { it->done = 1; }
+				break;
+			}
+		}
+		if (passed) { return val; }
+		// a stage after an exhausted take rejected its last element
+		if (it->done) { return NULL; }
+	}
+	it->done = 1;
+	return NULL;
+}
+void* __cyx_iter_collect(CyxIter it, struct __CyxArrayParams params) {
+	assert(params.__size == it.size && "ERROR: Collecting into a different type than the pipeline produces!");
+	if (!params.reserve) { params.reserve = it.hint ? it.hint : CYX_ARRAY_BASE_SIZE; }
+
+	void* res = __cyx_array_new(params);
+	assert(res);
+	void* val;
+	while ((val = cyx_iter_next(&it))) { __cyx_array_append(&res, val); }
+	return res;
+}
+void __cyx_iter_fold(CyxIter it, void* accumulator, void (*fn)(void*, const void*)) {
+	void* val;
+	while ((val = cyx_iter_next(&it))) { fn(accumulator, val); }
+}
+
+#endif // CYLIBX_IMPLEMENTATION
+
+#endif // __CYX_CLOSE_FOLD
+
 #endif // __CYLIBX_H__
@@ -14,6 +14,7 @@ void int_pow(void* dst, const void* src) { *(int*)dst = *(int*)src * *(int*)src;
 int int_filter(const void* n) { return *(int*)n % 2; }
 int int_eq(const void* const a, const void* const b) { return *(int*)a == *(int*)b; }
 void int_sum(void* acc, const void* b) { *(int*)acc += *(int*)b; }
+void int_mod_key(void* key, const void* n) { *(int*)key = *(int*)n % 5; }
 
 void set_has_string(char** set, const char* str) {
 	if (hashset_contains(set, str_from_lit(str), .defer = 1)) {
@@ -25,6 +26,10 @@ void set_has_string(char** set, const char* str) {
 
 typedef struct { char* key; int value; } KV;
 typedef struct { char* key; int* value; } KV2;
+typedef struct { int key; int value; } KV3;
+
+DEFINE_ARRAY(int_array, int, int_compare)
+DEFINE_SOA(points, (int, x), (int, y))
 
 // examples
 int main() {
@@ -45,9 +50,34 @@ int main() {
 		array_sort(array);
 		array_print(array);
 		putchar('\n');
+
+		int* eyt = array_build_eytzinger(array);
+		printf("25 is at %d, elements < 25: %zu, in eytzinger order at %d\n",
+			array_bsearch(array, 25), array_lower_bound(array, 25), array_eytzinger_bsearch(eyt, 25));
+		array_free(eyt);
+
+		int* smallest = array_top_k(array, 3);
+		printf("Three smallest elements: ");
+		array_print(smallest);
+		putchar('\n');
+		array_free(smallest);
 		
 		printf("Sum of all elements is: %d\n", *array_fold(array, 0, int_sum));
 
+		// same map -> filter -> fold chain in a single pass without intermediate arrays
+		int odd_squares = iter_fold(int, iter_filter(iter_map(iter_from_array(array), int, int_pow), int_filter), 0, int_sum);
+		printf("Sum of odd squares is: %d\n", odd_squares);
+		printf("Parallel sum of all elements is: %d\n", *array_fold_par(array, 0, int_sum, int_sum, 0));
+
+		int min, max;
+		array_min_max_i32(array, &min, &max);
+		printf("SIMD sum is: %ld, min: %d, max: %d, 7 appears %zu times\n", (long)array_sum_i32(array), min, max, array_count_eq_i32(array, 7));
+
+		size_t duplicates = array_unique_sorted(array);
+		printf("Removed %zu duplicates: ", duplicates);
+		array_print(array);
+		putchar('\n');
+
 		array_free(array);
 		array_free(new_arr);
 
@@ -69,7 +99,54 @@ int main() {
 		array_append_mult(mult_arr, 1, 2, 3, 4, 5);
 		array_print(mult_arr);
 		putchar('\n');
+
+		// ordered insertion and removal
+		array_insert_at(mult_arr, 2, 42);
+		array_remove_ordered(mult_arr, 0);
+		array_remove_if(mult_arr, int_filter);
+		array_print(mult_arr);
+		putchar('\n');
 		array_free(mult_arr);
+
+		// typed array, size and compare function known at compile time
+		int* typed_arr = int_array_new();
+		for (int i = 0; i < 10; ++i) { int_array_append(&typed_arr, rand() % 50); }
+		int_array_sort(typed_arr);
+		printf("Typed array min: %d, max: %d, 25 is at %d\n", *int_array_at(typed_arr, 0), typed_arr[array_length(typed_arr) - 1], int_array_bsearch(typed_arr, 25));
+		array_free(typed_arr);
+
+		// struct of arrays, every field is stored in its own column
+		points pts = points_new(0);
+		for (int i = 0; i < 5; ++i) { points_append(&pts, (points_row){ .x = rand() % 10, .y = i }); }
+		soa_sort_by(points, &pts, x, int_compare);
+		points_row first = points_at(&pts, 0);
+		printf("Point with the smallest x: (%d, %d), sum of y: %ld\n", first.x, first.y, (long)array_sum_i32(pts.y));
+		points_free(&pts);
+
+		// segmented array, appends never move the elements that are already stored
+		int** seg = segarray_new(int, .print_fn = int_print);
+		for (int i = 0; i < 40; ++i) { segarray_append(seg, i * i); }
+		int* seg_first = segarray_at(seg, 0);
+		segarray_append(seg, -1);
+		printf("First element still at the same address: %d, 20th element: %d\n", *seg_first, *segarray_at(seg, 20));
+		segarray_free(seg);
+
+		// small array, the first 8 elements are stored on the stack
+		int* small_arr = array_new_inline(int, 8, .print_fn = int_print);
+		array_append_mult(small_arr, 1, 2, 3);
+		array_print(small_arr);
+		putchar('\n');
+		array_free(small_arr);
+
+		// capacity management
+		int* sized_arr = array_new(int, .growth = 1.5f, .print_fn = int_print);
+		array_reserve(sized_arr, 1000);
+		array_resize(sized_arr, 5);
+		array_print(sized_arr);
+		putchar('\n');
+		array_clear(sized_arr);
+		array_shrink_to_fit(sized_arr);
+		array_free(sized_arr);
 	}
 
 	// string example
@@ -111,10 +188,68 @@ int main() {
 		bitmap_print(bits1);
 		putchar('\n');
 
+		printf("set bits (%zu):", bitmap_count(bits1));
+		bitmap_foreach_set(pos, bits1) { printf(" %zu", pos); }
+		printf("\nfirst zero: %zu, rank(10): %zu, select(0): %zu\n",
+				bitmap_find_first_zero(bits1), bitmap_rank(bits1, 10), bitmap_select(bits1, 0));
+		printf("|bits1 & bits2| = %zu, |bits1 & ~bits2| = %zu\n", bitmap_and_count(bits1, bits2), bitmap_andnot_count(bits1, bits2));
+
+		bitmap_set_range(bits2, 4, 16);
+		bitmap_flip_range(bits2, 8, 12);
+		printf("ranges: ");
+		bitmap_print(bits2);
+		printf(", all in [4, 8): %d, any in [8, 12): %d\n", bitmap_all_in_range(bits2, 4, 8), bitmap_any_in_range(bits2, 8, 12));
+
+		// slot allocation, the same calls are safe from several threads at once
+		size_t slot1 = bitmap_claim_first_zero(bits2, 0);
+		size_t slot2 = bitmap_claim_first_zero(bits2, slot1 + 1);
+		bitmap_test_and_clear(bits2, slot1);
+		printf("claimed slots %zu and %zu, released %zu, next claim: %zu\n", slot1, slot2, slot1, bitmap_claim_first_zero(bits2, 0));
+
+		// growing past the original size, new bits start cleared
+		bitmap_resize(bits1, 100);
+		bitmap_set(bits1, -1, 1);
+		size_t* mixed = bitmap_or(bits1, bits2);
+		printf("resized to %zu bits (capacity %zu), |bits1 | bits2| = %zu over %zu bits\n",
+				bitmap_size(bits1), bitmap_capacity(bits1), bitmap_count(mixed), bitmap_size(mixed));
+		bitmap_free(mixed);
+
 		bitmap_free(bits1);
 		bitmap_free(bits2);
 	}
 
+	// roaring bitmap example
+	printf("\nRoaring bitmap examples:\n"); {
+		CyxRoaring* evens = roaring_new();
+		CyxRoaring* block = roaring_new();
+		for (uint32_t i = 0; i < 1000000; i += 2) { roaring_add(evens, i); }
+		for (uint32_t i = 999990; i < 1000010; ++i) { roaring_add(block, i); }
+		roaring_add(block, 4000000000u);
+		roaring_optimize(block);
+
+		CyxRoaring* both = roaring_and(evens, block);
+		CyxRoaring* either = roaring_or(evens, block);
+		printf("evens: %zu values in %zu bytes\n", roaring_cardinality(evens), roaring_memory(evens));
+		printf("evens & block = ");
+		roaring_print(both);
+		printf("\n|evens | block| = %zu, contains 4e9: %d\n", roaring_cardinality(either), roaring_contains(either, 4000000000u));
+
+		size_t bytes = roaring_serialized_size(block);
+		char* buf = malloc(bytes);
+		roaring_serialize(block, buf);
+		CyxRoaring* restored = roaring_deserialize(buf, bytes);
+		printf("block round trip through %zu bytes: ", bytes);
+		roaring_print(restored);
+		putchar('\n');
+
+		free(buf);
+		roaring_free(restored);
+		roaring_free(either);
+		roaring_free(both);
+		roaring_free(block);
+		roaring_free(evens);
+	}
+
 	// hashset example
 	printf("\nHashSet examples:\n"); {
 		int* int_set = hashset_new(int, hash_int, int_eq, .print_fn = int_print);
@@ -243,6 +378,35 @@ int main() {
 		hashmap_print(str_to_arr);
 		putchar('\n');
 		hashmap_free(str_to_arr);
+
+		// group by example
+		int* nums = array_new(int);
+		for (size_t i = 0; i < 100; ++i) {
+			array_append(nums, rand() % 100);
+		}
+		KV3* sums_by_mod = array_group_by(KV3, nums, int_mod_key, hash_int, int_eq, NULL, int_sum, .print_key_fn = int_print, .print_value_fn = int_print);
+		hashmap_print(sums_by_mod);
+		putchar('\n');
+		hashmap_free(sums_by_mod);
+		array_free(nums);
+	}
+
+	// cuckoo filter example
+	printf("\nCuckooFilter examples:\n"); {
+		int* filter = cuckoo_new(int, hash_int, .reserve = 100, .fp_rate = 0.001);
+		for (int i = 0; i < 50; i += 2) {
+			cuckoo_add(filter, i);
+		}
+		for (int i = 0; i < 10; i += 4) {
+			cuckoo_remove(filter, i);
+		}
+		printf("%zu: [ ", cuckoo_length(filter));
+		for (int i = 0; i < 20; ++i) {
+			if (i) { printf(", "); }
+			printf("%d:%d", i, cuckoo_contains(filter, i));
+		}
+		printf(" ]\n");
+		cuckoo_free(filter);
 	}
 
 	// binary heap example